@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: cells.js
+// Contents: microbenchmark of the time to read each cell of a result set
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+// usage: node bench/cells.js [rows] [iterations]
+// Uses the connection string in test/test-config.js.  The nvarchar(max) column keeps the result set 
+// from being fetched in blocks, so every cell goes through the per column readers.
+
+var sql = require('../');
+var config = require('../test/test-config');
+
+var rows = parseInt(process.argv[2] || '100000', 10);
+var iterations = parseInt(process.argv[3] || '5', 10);
+
+var tsql = "SELECT TOP " + rows + " CONVERT(int, ROW_NUMBER() OVER (ORDER BY a.object_id)) AS i, " +
+           "CONVERT(bit, a.object_id % 2) AS b, CONVERT(float, a.object_id) / 3 AS f, " +
+           "a.name AS s, a.create_date AS d, CONVERT(varbinary(16), a.name) AS v, CONVERT(nvarchar(max), N'x') AS l " +
+           "FROM sys.all_objects a CROSS JOIN sys.all_objects b";
+var columns = 7;
+
+sql.open(config.conn_str, function (err, conn) {
+
+    if (err) {
+        throw err;
+    }
+
+    var times = [];
+
+    function run(iteration) {
+
+        if (iteration == iterations) {
+
+            times.sort(function (a, b) { return a - b; });
+            var median = times[Math.floor(times.length / 2)];
+            console.log(rows + " rows x " + columns + " columns: median " + median.toFixed(1) + " ms, " + 
+                        (median * 1e6 / (rows * columns)).toFixed(1) + " ns per cell");
+            conn.close(function () {});
+            return;
+        }
+
+        var start = process.hrtime();
+
+        conn.queryRaw(tsql, function (err, results) {
+
+            if (err) {
+                throw err;
+            }
+
+            var elapsed = process.hrtime(start);
+            times.push(elapsed[0] * 1e3 + elapsed[1] / 1e6);
+            run(iteration + 1);
+        });
+    }
+
+    run(0);
+});
@@ -0,0 +1,97 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: dates.js
+// Contents: microbenchmark of converting dates across the SQL Server range
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+// usage: node bench/dates.js [rows] [iterations]
+// Uses the connection string in test/test-config.js.  Times reading datetime2 values spread from year 1 
+// to 9999, as each form the dates query option returns, and sending 2000 date parameters spread the same way.
+
+var sql = require('../');
+var config = require('../test/test-config');
+
+var rows = parseInt(process.argv[2] || '200000', 10);
+var iterations = parseInt(process.argv[3] || '5', 10);
+
+var firstDay = -62135596800000;     // 0001-01-01 UTC
+var msPerDay = 86400000;
+var dayCount = 3652059;
+
+var tsql = "SELECT TOP " + rows + " DATEADD(day, CONVERT(int, ROW_NUMBER() OVER (ORDER BY (SELECT NULL)) % " + dayCount + "), " +
+           "CONVERT(datetime2, '00010101')) FROM sys.all_objects a CROSS JOIN sys.all_objects b";
+
+var params = [];
+for (var p = 0; p < 2000; ++p) {
+    params.push(new Date(firstDay + Math.floor(p * dayCount / 2000) * msPerDay));
+}
+var paramTsql = "SELECT COUNT(*) FROM (VALUES " + params.map(function () { return "(?)"; }).join(",") + ") AS v(d)";
+
+function median(times) {
+
+    times.sort(function (a, b) { return a - b; });
+    return times[Math.floor(times.length / 2)];
+}
+
+sql.open(config.conn_str, function (err, conn) {
+
+    if (err) {
+        throw err;
+    }
+
+    function time(name, query, args, iteration, times, next) {
+
+        if (iteration == iterations) {
+            console.log(name + ": median " + median(times).toFixed(1) + " ms");
+            next();
+            return;
+        }
+
+        var start = process.hrtime();
+
+        conn.queryRaw(query, args, function (err, results) {
+
+            if (err) {
+                throw err;
+            }
+
+            var elapsed = process.hrtime(start);
+            times.push(elapsed[0] * 1e3 + elapsed[1] / 1e6);
+            time(name, query, args, iteration + 1, times, next);
+        });
+    }
+
+    var modes = ['date', 'plain', 'number'];
+
+    function read(mode) {
+
+        if (mode == modes.length) {
+
+            time("2000 date parameters sent", paramTsql, params, 0, [], function () {
+
+                conn.close(function () {});
+            });
+            return;
+        }
+
+        time(rows + " datetime2 values read as " + modes[mode], { query_str: tsql, dates: modes[mode] }, [], 0, [], function () {
+
+            read(mode + 1);
+        });
+    }
+
+    read(0);
+});
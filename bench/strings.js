@@ -0,0 +1,90 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: strings.js
+// Contents: benchmark of reading string columns of different widths
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+// usage: node bench/strings.js [rows] [iterations]
+// Uses the connection string in test/test-config.js.  Reads ASCII nvarchar and varchar columns of each 
+// width, the varchar ones both as UTF-16 and narrowed (the narrowVarchar query option).
+
+var sql = require('../');
+var config = require('../test/test-config');
+
+var rows = parseInt(process.argv[2] || '20000', 10);
+var iterations = parseInt(process.argv[3] || '5', 10);
+
+var widths = [8, 64, 256, 1024, 8000];
+var cases = [];
+
+widths.forEach(function (width) {
+
+    var text = "REPLICATE('abcdefgh', " + Math.ceil(width / 8) + ")";
+    var from = " FROM sys.all_objects a CROSS JOIN sys.all_objects b";
+
+    cases.push({ name: 'nvarchar(' + width + ')', options: {},
+                 tsql: "SELECT TOP " + rows + " CONVERT(nvarchar(" + width + "), " + text + ")" + from });
+    cases.push({ name: 'varchar(' + width + ')', options: {},
+                 tsql: "SELECT TOP " + rows + " CONVERT(varchar(" + width + "), " + text + ")" + from });
+    cases.push({ name: 'varchar(' + width + ') narrow', options: { narrowVarchar: true },
+                 tsql: "SELECT TOP " + rows + " CONVERT(varchar(" + width + "), " + text + ")" + from });
+});
+
+sql.open(config.conn_str, function (err, conn) {
+
+    if (err) {
+        throw err;
+    }
+
+    function run(index, iteration, times) {
+
+        if (index == cases.length) {
+            conn.close(function () {});
+            return;
+        }
+
+        var current = cases[index];
+
+        if (iteration == iterations) {
+
+            times.sort(function (a, b) { return a - b; });
+            var median = times[Math.floor(times.length / 2)];
+            console.log(current.name + ": median " + median.toFixed(1) + " ms for " + rows + " rows");
+            run(index + 1, 0, []);
+            return;
+        }
+
+        var query = { query_str: current.tsql };
+        for (var option in current.options) {
+            query[option] = current.options[option];
+        }
+
+        var start = process.hrtime();
+
+        conn.queryRaw(query, function (err, results) {
+
+            if (err) {
+                throw err;
+            }
+
+            var elapsed = process.hrtime(start);
+            times.push(elapsed[0] * 1e3 + elapsed[1] / 1e6);
+            run(index, iteration + 1, times);
+        });
+    }
+
+    run(0, 0, []);
+});
@@ -5,12 +5,15 @@
 
       'sources': [ 
         'src/Column.cpp',
+        'src/Columnar.cpp',
         'src/Connection.cpp',
         'src/OdbcConnection.cpp',
         'src/OdbcError.cpp',
         'src/OdbcOperation.cpp',
+        'src/ParamArray.cpp',
         'src/ResultSet.cpp',
         'src/stdafx.cpp',
+        'src/Text.cpp',
         'src/Utility.cpp',
       ],
 
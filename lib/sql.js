@@ -20,6 +20,18 @@
 var sql = require('./sqlserver.native');
 var events = require('events');
 var util = require('util');
+var stream = require('stream');
+
+// object mode streams are only built in from node.js 0.10 on
+var Readable = stream.Readable || require('readable-stream').Readable;
+var Writable = stream.Writable || require('readable-stream').Writable;
+
+// number of rows read from the native layer per call.  Each call is a round trip through the
+// thread pool, so reading many rows at once amortizes that cost over the whole batch.
+var ROWS_PER_READ = 256;
+
+// number of rows bulkLoad sends to the server and commits at a time
+var BULK_ROWS_PER_BATCH = 10000;
 
 function StreamEvents() {
     events.EventEmitter.call(this);
@@ -62,6 +74,26 @@ function validateParameters( parameters, funcName ) {
     }
 }
 
+// a query is either the query string or an object with the string in query_str and options that 
+// control how its parameters are bound and its results are read:
+//   prefetch       number of batches of rows to read ahead
+//   lobChunkSize   size of the pieces large object values are returned in, 0 for whole values
+//   lobSink        { column, path } writes the values of that column one after another to the file at 
+//                  path without passing through Javascript, returning the number of bytes of each instead
+//   narrowVarchar  read char and varchar columns in the client code page instead of UTF-16
+//   bigint         'string' returns bigint values exactly as strings instead of numbers
+//   decimal        'string' returns decimal, numeric and money values exactly as strings instead of numbers
+//   dates          'plain' returns dates without their nanosecondsDelta property, which is cheaper to create, 
+//                  and 'number' as milliseconds since Jan 1, 1970 UTC
+//   paramSizes     how string and Buffer parameters are declared to the server.  By default their size is 
+//                  rounded up to 64, 256, 4000 (8000 for Buffers) or max, so one plan serves values of many
+//                  lengths.  'exact' declares each value's own length, and an array gives the size of each 
+//                  parameter in turn (0 for max), with null using the rounded size
+function queryString( query ) {
+
+    return ( typeof query == 'object' && query != null ) ? query.query_str : query;
+}
+
 function query_internal(ext, query, params, callback) {
 
     function onQuery(err, results) {
@@ -71,7 +103,9 @@ function query_internal(ext, query, params, callback) {
         }
     }
 
-    return ext.query(query, params, onQuery);
+    var options = ( typeof query == 'object' ) ? query : {};
+
+    return ext.query(queryString( query ), params, options, onQuery);
 }
 
 
@@ -107,46 +141,459 @@ function getChunkyArgs(paramsOrCallback, callback) {
     throw new Error( "[msnodesql] Invalid parameter(s) passed to function query or queryRaw." );
 }
 
-function objectify(results) {
+// add the next piece of a value returned in pieces (see lobChunkSize) to what has been read of it
+function appendPiece(value, piece) {
 
-    var names = {};
-    var name, idx;
+    return Buffer.isBuffer(value) ? Buffer.concat([value, piece]) : value + piece;
+}
+
+// unique property names of the columns of a result set, by column index.  Rows are built as objects 
+// with these names by the native layer, which names the columns the same way: a name that is empty or 
+// already used by an earlier column becomes Column<index> (or Column<index>_<n> if that is taken too).
+function columnKeys(meta) {
+
+    var keys = [];
+    var used = {};
 
-    for (idx in results.meta) {
-        var meta = results.meta[idx];
-        name = meta.name;
-        if (name !== '' && names[name] === undefined) {
-            names[name] = idx;
+    for (var idx = 0; idx < meta.length; ++idx) {
+        var name = meta[idx].name;
+        if (name === '' || Object.prototype.hasOwnProperty.call(used, name)) {
+            var extra = 0;
+            name = 'Column' + idx;
+            while (Object.prototype.hasOwnProperty.call(used, name)) {
+                name = 'Column' + idx + '_' + extra++;
+            }
+        }
+        used[name] = true;
+        keys.push(name);
+    }
+
+    return keys;
+}
+
+// Object mode Readable stream of the rows of a query.  Rows are only read from the server when the 
+// stream's buffer is below its highWaterMark, so a slow consumer pauses fetching rather than having
+// the whole result buffered in memory.  Each result set's metadata is emitted as a 'meta' event and 
+// the rows affected by a statement without results as a 'rowcount' event.
+function RowStream(q, ext, query, params, options) {
+
+    options = options || {};
+
+    Readable.call(this, { objectMode: true, highWaterMark: options.highWaterMark || ROWS_PER_READ });
+
+    this._q = q;
+    this._ext = ext;
+    this._query = query;
+    this._params = params;
+    this._raw = options.raw === true;
+    this._batchSize = options.highWaterMark || ROWS_PER_READ;
+    this._meta = null;
+    this._keys = null;
+    this._started = false;      // the query has been executed and rows may be read
+    this._reading = false;      // a read is outstanding in the native layer
+    this._wanted = false;       // the consumer asked for more rows
+}
+util.inherits(RowStream, Readable);
+
+RowStream.prototype._read = function () {
+
+    this._wanted = true;
+
+    if (this._started && !this._reading) {
+        this._readRows();
+    }
+}
+
+// called when this stream reaches the front of the connection's queue
+RowStream.prototype._start = function () {
+
+    var self = this;
+
+    query_internal(self._ext, self._query, self._params, function (err, meta) {
+
+        if (err) {
+            self._fail(err);
+            return;
+        }
+
+        self._startResults(meta);
+    });
+}
+
+RowStream.prototype._fail = function (err) {
+
+    this.emit('error', err);
+    nextOp(this._q);
+}
+
+RowStream.prototype._startResults = function (meta) {
+
+    this._meta = meta;
+    this._keys = columnKeys(meta);
+
+    if (meta.length == 0) {
+
+        this.emit('rowcount', this._ext.readRowCount());
+        this._nextResult();
+        return;
+    }
+
+    this.emit('meta', meta);
+    this._started = true;
+
+    if (this._wanted) {
+        this._readRows();
+    }
+}
+
+RowStream.prototype._nextResult = function () {
+
+    var self = this;
+
+    self._started = false;
+    self._reading = true;
+
+    self._ext.nextResult(function (err, nextResultSetInfo) {
+
+        self._reading = false;
+
+        if (err) {
+            self._fail(err);
+            return;
+        }
+
+        if (nextResultSetInfo.endOfResults) {
+
+            self.push(null);
+            nextOp(self._q);
+            return;
+        }
+
+        self._startResults(nextResultSetInfo.meta);
+    });
+}
+
+RowStream.prototype._readRows = function () {
+
+    var self = this;
+
+    self._reading = true;
+
+    self._ext.readRows(self._batchSize, !self._raw, function (err, results) {
+
+        if (err) {
+            self._reading = false;
+            self._fail(err);
+            return;
+        }
+
+        var batch = results.rows;
+        var complete = results.more ? batch.length - 1 : batch.length;
+
+        for (var r = 0; r < complete; ++r) {
+            self._pushRow(batch[r]);
+        }
+
+        if (results.more) {
+            self._readColumns(batch[complete], results.column, true, onRowComplete);
         }
         else {
-            var extra = 0;
-            var candidate = 'Column' + idx;
-            while (names[candidate] !== undefined) {
-                candidate = 'Column' + idx + '_' + extra++;
+            onRowComplete();
+        }
+
+        function onRowComplete() {
+
+            self._reading = false;
+
+            if (results.endOfRows) {
+                self._nextResult();
+            }
+            else if (self._wanted) {
+                self._readRows();
             }
-            names[candidate] = idx;
         }
+    });
+}
+
+// finish reading a row a column at a time after a LOB column that has more data
+RowStream.prototype._readColumns = function (row, column, more, done) {
+
+    var self = this;
+
+    self._ext.readColumn(column, function (err, results) {
+
+        if (err) {
+            self._reading = false;
+            self._fail(err);
+            return;
+        }
+
+        var key = self._raw ? column : self._keys[column];
+
+        row[key] = more ? appendPiece(row[key], results.data) : results.data;
+
+        if (results.more) {
+            self._readColumns(row, column, true, done);
+        }
+        else if (column + 1 < self._meta.length) {
+            self._readColumns(row, column + 1, false, done);
+        }
+        else {
+            self._pushRow(row);
+            done();
+        }
+    });
+}
+
+RowStream.prototype._pushRow = function (row) {
+
+    if (!this.push(row)) {
+        this._wanted = false;
     }
+}
 
-    var rows = [];
-    for (idx in results.rows) {
-        var row = results.rows[idx];
-        var value = {};
-        for (name in names) {
-            value[name] = row[names[name]];
+// a table name, optionally qualified with its schema and database, with each part quoted in brackets so it
+// can be put in a query as is.  Parts already in brackets are kept, and any ] is escaped as ]].
+function quoteTableName(name) {
+
+    var parts = [];
+    var i = 0;
+
+    while( i <= name.length ) {
+
+        var part = '';
+        if( name.charAt( i ) == '[' ) {
+
+            for( ++i; i < name.length; ++i ) {
+                if( name.charAt( i ) == ']' ) {
+                    if( name.charAt( i + 1 ) != ']' ) {
+                        ++i;
+                        break;
+                    }
+                    ++i;
+                }
+                part += name.charAt( i );
+            }
+            // anything between the closing bracket and the next dot belongs to the part too
+            while( i < name.length && name.charAt( i ) != '.' ) {
+                part += name.charAt( i++ );
+            }
+        }
+        else {
+
+            while( i < name.length && name.charAt( i ) != '.' ) {
+                part += name.charAt( i++ );
+            }
+        }
+
+        // an empty part, as in db..table, stands for the default schema and stays empty
+        parts.push( part.length > 0 ? '[' + part.replace( /]/g, ']]' ) + ']' : '' );
+        ++i;    // past the dot
+    }
+
+    return parts.join( '.' );
+}
+
+// Object mode Writable stream that bulk copies rows into a table with the bcp API.  Rows are arrays 
+// in the order of columns, or objects keyed by column name.  They are sent to the server in batches 
+// of options.batchSize rows, each committed on its own, so a write only completes once its batch has 
+// been sent.  options.hints are the bcp hints, TABLOCK by default so the server can minimally log the 
+// load.  Once the stream ends and every row is committed, 'done' is emitted with the rows loaded.
+function BulkLoadStream(q, ext, table, columns, options) {
+
+    options = options || {};
+
+    var batchSize = options.batchSize || BULK_ROWS_PER_BATCH;
+
+    Writable.call(this, { objectMode: true, highWaterMark: batchSize });
+
+    this._q = q;
+    this._ext = ext;
+    this._table = table;
+    this._quotedTable = quoteTableName(table);
+    this._columns = columns;
+    this._hints = ( typeof options.hints == 'string' ) ? options.hints : 'TABLOCK';
+    this._batchSize = batchSize;
+    this._ordinals = null;      // table column of each of columns once the load has started
+    this._rows = [];            // rows of the batch not yet sent
+    this._pending = null;       // callback of a write waiting for the load to start
+    this._ending = false;       // the stream finished before the load started
+    this._failed = false;
+    this._loaded = 0;
+
+    this.on('finish', this._finish);
+}
+util.inherits(BulkLoadStream, Writable);
+
+// called when this stream reaches the front of the connection's queue.  The columns are looked up by 
+// name in the table's metadata, since bcp binds them by their position in the table.
+BulkLoadStream.prototype._start = function () {
+
+    var self = this;
+
+    self._ext.query('SELECT TOP 0 * FROM ' + self._quotedTable, [], {}, function (err, meta) {
+
+        if (err) {
+            self._fail(err);
+            return;
+        }
+
+        self._ext.nextResult(function (err) {
+
+            if (err) {
+                self._fail(err);
+                return;
+            }
+
+            var ordinals = [];
+            for (var c = 0; c < self._columns.length; ++c) {
+
+                var ordinal = 0;
+                for (var i = 0; i < meta.length; ++i) {
+                    if (meta[i].name == self._columns[c]) {
+                        ordinal = i + 1;
+                        break;
+                    }
+                }
+
+                if (ordinal == 0) {
+                    self._fail(new Error("[msnodesql] Column " + self._columns[c] + " not found in table " + self._table + "."));
+                    return;
+                }
+                ordinals.push(ordinal);
+            }
+
+            self._ext.bulkInit(self._quotedTable, self._hints, function (err) {
+
+                if (err) {
+                    self._fail(err);
+                    return;
+                }
+
+                self._ordinals = ordinals;
+
+                if (self._pending) {
+                    var callback = self._pending;
+                    self._pending = null;
+                    self._send(callback);
+                }
+                else if (self._ending) {
+                    self._finish();
+                }
+            });
+        });
+    });
+}
+
+BulkLoadStream.prototype._write = function (row, encoding, callback) {
+
+    if (this._failed) {
+        callback();
+        return;
+    }
+
+    if (!Array.isArray(row)) {
+        row = this._columns.map(function (name) { return row[name] === undefined ? null : row[name]; });
+    }
+    this._rows.push(row);
+
+    if (this._rows.length < this._batchSize) {
+        callback();
+    }
+    else if (this._ordinals) {
+        this._send(callback);
+    }
+    else {
+        this._pending = callback;
+    }
+}
+
+BulkLoadStream.prototype._send = function (callback) {
+
+    var self = this;
+    var rows = self._rows;
+
+    self._rows = [];
+
+    self._ext.bulkSend(rows, self._ordinals, function (err, sent) {
+
+        if (err) {
+            self._fail(err);
+            return;
         }
-        rows.push(value);
+
+        self._loaded += sent;
+        callback();
+    });
+}
+
+// sends the last partial batch and ends the bulk copy
+BulkLoadStream.prototype._finish = function () {
+
+    var self = this;
+
+    if (self._failed) {
+        return;
+    }
+
+    if (!self._ordinals) {
+        self._ending = true;
+        return;
+    }
+
+    function done() {
+
+        self._ext.bulkDone(function (err, rowcount) {
+
+            nextOp(self._q);
+
+            if (err) {
+                self.emit('error', err);
+                return;
+            }
+
+            self.emit('done', self._loaded + rowcount);
+        });
     }
 
-    return rows;
+    if (self._rows.length == 0) {
+        done();
+    }
+    else {
+        self._send(done);
+    }
+}
+
+// ends the bulk copy, keeping the batches already committed, and frees the connection for the next operation
+BulkLoadStream.prototype._fail = function (err) {
+
+    var self = this;
+
+    self._failed = true;
+    self._rows = [];
+
+    self._ext.bulkDone(function () {
+
+        self.emit('error', err);
+        nextOp(self._q);
+    });
+
+    // a write waiting on the load is released so the stream doesn't stall
+    if (self._pending) {
+        var callback = self._pending;
+        self._pending = null;
+        callback();
+    }
 }
 
 // TODO: Simplify this to use only events, and then subscribe in Connection.query
 // and Connection.queryRaw to build callback results
-function readall(q, notify, ext, query, params, callback) {
+// When objects is true, rows are returned as objects keyed by column name rather than arrays.
+function readall(q, notify, ext, query, params, objects, callback) {
 
 
     var meta;
+    var keys;
     var column;
     var rows = [];
     var rowindex = 0;
@@ -165,7 +612,8 @@ function readall(q, notify, ext, query, params, callback) {
         notify.emit('column', column, data, more);
 
         if (callback) {
-            rows[rows.length - 1][column] += data;
+            var key = objects ? keys[column] : column;
+            rows[rows.length - 1][key] = appendPiece(rows[rows.length - 1][key], data);
         }
 
         if (more) {
@@ -175,7 +623,7 @@ function readall(q, notify, ext, query, params, callback) {
 
         column++;
         if (column >= meta.length) {
-            ext.readRow(onReadRow);
+            ext.readRows(ROWS_PER_READ, objects, onReadRows);
             return;
         }
 
@@ -196,7 +644,7 @@ function readall(q, notify, ext, query, params, callback) {
         notify.emit('column', column, data, more);
 
         if (callback) {
-            rows[rows.length - 1][column] = data;
+            rows[rows.length - 1][objects ? keys[column] : column] = data;
         }
 
         if (more) {
@@ -207,7 +655,7 @@ function readall(q, notify, ext, query, params, callback) {
         column++;
 
         if (column >= meta.length) {
-            ext.readRow(onReadRow);
+            ext.readRows(ROWS_PER_READ, objects, onReadRows);
             return;
         }
 
@@ -255,6 +703,7 @@ function readall(q, notify, ext, query, params, callback) {
 
         // reset for the next resultset
         meta = nextResultSetInfo.meta;
+        keys = columnKeys(meta);
         rows = [];
 
         if( nextResultSetInfo.endOfResults ) {
@@ -269,7 +718,7 @@ function readall(q, notify, ext, query, params, callback) {
                 notify.emit( 'meta', meta );
                     
                 // kick off reading next set of rows
-                ext.readRow( onReadRow );
+                ext.readRows( ROWS_PER_READ, objects, onReadRows );
             }
             else {
 
@@ -278,24 +727,45 @@ function readall(q, notify, ext, query, params, callback) {
         }            
     }
 
-    function onReadRow( err, endOfRows ) {
+    // rows are read in batches of whole rows.  If the last column of the last row returned has more 
+    // data (a LOB), the rest of it and any columns after it are read one at a time through readColumn.
+    function onReadRows( err, results ) {
 
         if (err) {
             routeStatementError(err, callback, notify);
             nextOp(q);
             return;
         }
-        // if there were rows and we haven't reached the end yet (like EOF)
-        else if (meta.length > 0 && !endOfRows) {
+
+        var batch = results.rows;
+
+        for (var r = 0; r < batch.length; ++r) {
+
+            var data = batch[r];
+            // a row whose LOB column has more data has only the columns up to that one
+            var last = (results.more && r == batch.length - 1) ? results.column : meta.length - 1;
 
             notify.emit('row', rowindex++);
 
-            column = 0;
             if (callback) {
-                rows[rows.length] = [];
+                rows[rows.length] = data;
             }
 
-            ext.readColumn(column, onReadColumn);
+            for (column = 0; column < last; ++column) {
+                notify.emit('column', column, data[objects ? keys[column] : column], false);
+            }
+            notify.emit('column', last, data[objects ? keys[last] : last], results.more && r == batch.length - 1);
+        }
+
+        if (results.more) {
+            ext.readColumn(column, onReadColumnMore);
+            return;
+        }
+
+        // if we haven't reached the end yet (like EOF), read the next batch
+        if (!results.endOfRows) {
+
+            ext.readRows(ROWS_PER_READ, objects, onReadRows);
         }
         // otherwise, go to the next result set
         else {
@@ -313,10 +783,11 @@ function readall(q, notify, ext, query, params, callback) {
         }
 
         meta = results;
+        keys = columnKeys(meta);
         if (meta.length > 0) {
 
             notify.emit('meta', meta);
-            ext.readRow( onReadRow );
+            ext.readRows( ROWS_PER_READ, objects, onReadRows );
         }
         else {
 
@@ -325,7 +796,94 @@ function readall(q, notify, ext, query, params, callback) {
     });
 }
 
-function open(connectionString, callback) {
+// used by Connection.queryColumnar.  Each result set is read in one background operation into one 
+// typed array per column and passed to the callback as { meta, rows, columns }.  Statements without 
+// results are passed as { meta: null, rowcount }.  more is true while there are result sets to follow.
+function readcolumnar(q, ext, query, params, callback) {
+
+    var meta;
+
+    function onNextResult( err, nextResultSetInfo ) {
+
+        if( err ) {
+            callback( err );
+            nextOp( q );
+            return;
+        }
+
+        if( meta.length == 0 ) {
+            callback( null, { meta: null, rowcount: ext.readRowCount() }, !nextResultSetInfo.endOfResults );
+        }
+
+        if( nextResultSetInfo.endOfResults ) {
+            nextOp( q );
+            return;
+        }
+
+        startResults( nextResultSetInfo.meta );
+    }
+
+    function startResults( results ) {
+
+        meta = results;
+
+        if( meta.length == 0 ) {
+            ext.nextResult( onNextResult );
+            return;
+        }
+
+        ext.readColumnar( function( err, columnar ) {
+
+            if( err ) {
+                callback( err );
+                nextOp( q );
+                return;
+            }
+
+            ext.nextResult( function( err, nextResultSetInfo ) {
+
+                if( err ) {
+                    callback( err );
+                    nextOp( q );
+                    return;
+                }
+
+                callback( null, { meta: meta, rows: columnar.rows, columns: columnar.columns }, !nextResultSetInfo.endOfResults );
+
+                if( nextResultSetInfo.endOfResults ) {
+                    nextOp( q );
+                    return;
+                }
+
+                startResults( nextResultSetInfo.meta );
+            });
+        });
+    }
+
+    query_internal(ext, query, params, function (err, results) {
+
+        if (err) {
+            callback(err);
+            nextOp(q);
+            return;
+        }
+
+        startResults( results );
+    });
+}
+
+// open a connection.  options is optional:
+//   bulkLoad       enable bulk copy on the connection so conn.bulkLoad can be used.  This loads the bulk copy
+//                  functions from the driver and is left off otherwise.
+function open(connectionString, optionsOrCallback, callback) {
+
+    var openOptions = {};
+    if( typeof optionsOrCallback == 'function' ) {
+        callback = optionsOrCallback;
+    }
+    else if( typeof optionsOrCallback == 'object' && optionsOrCallback != null ) {
+        openOptions = optionsOrCallback;
+    }
 
     validateParameters( [ { type: 'string', value: connectionString, name: 'connection string' },
                           { type: 'function', value: callback, name: 'callback' }], 'open' );
@@ -370,6 +928,11 @@ function open(connectionString, callback) {
             this.close =            function() { /* noop */ }
             this.queryRaw =         function() { throw new Error( "[msnodesql] Connection is closed." ); }
             this.query =            function() { throw new Error( "[msnodesql] Connection is closed." ); }
+            this.queryStream =      function() { throw new Error( "[msnodesql] Connection is closed." ); }
+            this.queryColumnar =    function() { throw new Error( "[msnodesql] Connection is closed." ); }
+            this.executeBatch =     function() { throw new Error( "[msnodesql] Connection is closed." ); }
+            this.bulkLoad =         function() { throw new Error( "[msnodesql] Connection is closed." ); }
+            this.paramSignatures =  function() { throw new Error( "[msnodesql] Connection is closed." ); }
             this.beginTransaction = function() { throw new Error( "[msnodesql] Connection is closed." ); }
             this.commit =           function() { throw new Error( "[msnodesql] Connection is closed." ); }
             this.rollback =         function() { throw new Error( "[msnodesql] Connection is closed." ); }
@@ -387,40 +950,157 @@ function open(connectionString, callback) {
             }
         }
 
-        this.queryRaw = function (query, paramsOrCallback, callback) {
-
-            validateParameters( [ { type: 'string', value: query, name: 'query string' }], 'queryRaw' );
+        function queueReadall(query, params, objects, callback) {
 
             var notify = new StreamEvents();
 
-            var chunky = getChunkyArgs(paramsOrCallback, callback);
-
-            var op = { fn: readall, args: [ q, notify, ext, query, chunky.params, chunky.callback ] }; 
+            var op = { fn: readall, args: [ q, notify, ext, query, params, objects, callback ] }; 
             q.push( op );
             
             if( q.length == 1 ) {
 
-                readall( q, notify, ext, query, chunky.params, chunky.callback );
+                readall( q, notify, ext, query, params, objects, callback );
             }
 
             return notify;
         }
 
+        this.queryRaw = function (query, paramsOrCallback, callback) {
+
+            validateParameters( [ { type: 'string', value: queryString( query ), name: 'query string' }], 'queryRaw' );
+
+            var chunky = getChunkyArgs(paramsOrCallback, callback);
+
+            return queueReadall(query, chunky.params, false, chunky.callback);
+        }
+
         this.query = function (query, paramsOrCallback, callback) {
 
-            validateParameters( [ { type: 'string', value: query, name: 'query string' }], 'query' );
+            validateParameters( [ { type: 'string', value: queryString( query ), name: 'query string' }], 'query' );
 
             var chunky = getChunkyArgs(paramsOrCallback, callback);
 
-            function onQueryRaw( err, results, more ) {
+            function onQuery( err, results, more ) {
 
                 if (chunky.callback) {
                     if (err) chunky.callback(err);
-                    else chunky.callback(err, objectify(results), more);
+                    else chunky.callback(err, results.rows || [], more);
                 }
             }
 
-            return this.queryRaw(query, chunky.params, onQueryRaw);
+            return queueReadall(query, chunky.params, true, onQuery);
+        }
+
+        // returns an object mode Readable stream of the rows.  Rows are objects as returned by query, or 
+        // arrays as returned by queryRaw when options.raw is true.  options.highWaterMark sets the number 
+        // of rows buffered in the stream and read from the server at a time.
+        this.queryStream = function (query, params, options) {
+
+            validateParameters( [ { type: 'string', value: queryString( query ), name: 'query string' }], 'queryStream' );
+
+            var rows = new RowStream(q, ext, query, params || [], options);
+
+            var op = { fn: function() { rows._start(); }, args: [] };
+            q.push( op );
+
+            if( q.length == 1 ) {
+
+                rows._start();
+            }
+
+            return rows;
+        }
+
+        // returns each result set by column rather than by row.  Each column is { type, values, nulls } 
+        // for fixed width types, where values is a typed array, or { type, offsets, data, nulls } for text 
+        // (UTF-16LE) and binary values, where value i is data[offsets[i]..offsets[i+1]).  Bit i of nulls is
+        // set when value i is null.
+        this.queryColumnar = function (query, paramsOrCallback, callback) {
+
+            validateParameters( [ { type: 'string', value: queryString( query ), name: 'query string' }], 'queryColumnar' );
+
+            var chunky = getChunkyArgs(paramsOrCallback, callback);
+
+            chunky.callback = chunky.callback || function( err ) { if( err ) { throw new Error( err ); } };
+
+            var op = { fn: readcolumnar, args: [ q, ext, query, chunky.params, chunky.callback ] };
+            q.push( op );
+
+            if( q.length == 1 ) {
+
+                readcolumnar( q, ext, query, chunky.params, chunky.callback );
+            }
+        }
+
+        // executes query once for each element of rows, an array of parameter arrays, in a single round trip.
+        // The callback receives { rowcount, status } where rowcount is the total rows affected and status[i] 
+        // is 'success', 'info', 'error', 'unused' or 'unavailable' for rows[i].  Each column is laid out at the 
+        // size of its longest value; a string or Buffer column that would take more than 16MB that way is sent a
+        // value at a time instead, which costs a call to the driver per value.
+        this.executeBatch = function (query, rows, callback) {
+
+            validateParameters( [ { type: 'string', value: query, name: 'query string' }], 'executeBatch' );
+
+            if( !Array.isArray( rows )) {
+
+                throw new Error( "[msnodesql] Invalid rows passed to function executeBatch. Type should be array." );
+            }
+
+            function onExecuteBatch( err, results ) {
+
+                callback( err, results );
+
+                nextOp( q );
+            }
+
+            callback = callback || defaultCallback;
+
+            var op = { fn: function( callback ) { ext.executeBatch( query, rows, callback ); }, args: [ onExecuteBatch ] };
+            q.push( op );
+
+            if( q.length == 1 ) {
+
+                ext.executeBatch( query, rows, onExecuteBatch );
+            }
+        }
+
+        // returns a Writable stream of rows bulk copied into table.  columns names the table columns each 
+        // row gives values for.  See BulkLoadStream for the options.
+        this.bulkLoad = function (table, columns, options) {
+
+            validateParameters( [ { type: 'string', value: table, name: 'table name' }], 'bulkLoad' );
+
+            if( !Array.isArray( columns ) || columns.length == 0 ) {
+
+                throw new Error( "[msnodesql] Invalid columns passed to function bulkLoad. Type should be a non-empty array." );
+            }
+
+            if( !openOptions.bulkLoad ) {
+
+                throw new Error( "[msnodesql] Connection must be opened with the bulkLoad option to use function bulkLoad." );
+            }
+
+            options = options || {};
+
+            var load = new BulkLoadStream(q, ext, table, columns, options);
+
+            var op = { fn: function() { load._start(); }, args: [] };
+            q.push( op );
+
+            if( q.length == 1 ) {
+
+                load._start();
+            }
+
+            return load;
+        }
+
+        // the number of distinct sets of declared parameter types query has run with on this connection, or 
+        // every query when none is given.  The server compiles a plan for each, so with paramSizes left to 
+        // round sizes up this should stay small however many different values are passed.
+        this.paramSignatures = function (query) {
+
+            return ext.paramSignatures( query ? queryString( query ) : '' );
         }
 
         this.beginTransaction = function(callback) {
@@ -493,7 +1173,7 @@ function open(connectionString, callback) {
 
     callback = callback || defaultCallback;
 
-    ext.open(connectionString, onOpen);
+    ext.open(connectionString, onOpen, !!openOptions.bulkLoad);
 
     return connection;
 }
@@ -501,14 +1181,14 @@ function open(connectionString, callback) {
 function query(connectionString, query, paramsOrCallback, callback) {
 
     validateParameters( [ { type: 'string', value: connectionString, name: 'connection string' },
-                          { type: 'string', value: query, name: 'query string' }], 'query' );
+                          { type: 'string', value: queryString( query ), name: 'query string' }], 'query' );
 
     var chunky = getChunkyArgs(paramsOrCallback, callback);
 
-    return queryRaw(connectionString, query, chunky.params, function (err, results, more) {
+    return queryOnce(connectionString, query, chunky.params, true, function (err, results, more) {
         if (chunky.callback) {
             if (err) chunky.callback(err);
-            else chunky.callback(err, objectify(results), more);
+            else chunky.callback(err, results.rows || [], more);
         }
     });
 }
@@ -516,13 +1196,21 @@ function query(connectionString, query, paramsOrCallback, callback) {
 function queryRaw(connectionString, query, paramsOrCallback, callback) {
 
     validateParameters( [ { type: 'string', value: connectionString, name: 'connection string' },
-                          { type: 'string', value: query, name: 'query string' }], 'queryRaw' );
+                          { type: 'string', value: queryString( query ), name: 'query string' }], 'queryRaw' );
+
+    var chunky = getChunkyArgs(paramsOrCallback, callback);
+
+    return queryOnce(connectionString, query, chunky.params, false, chunky.callback);
+}
+
+// open a connection, run the query on it and close it once all the results are read
+function queryOnce(connectionString, query, params, objects, callback) {
 
     var ext = new sql.Connection();
     var notify = new StreamEvents();
     var q = [];
 
-    var chunky = getChunkyArgs(paramsOrCallback, callback);
+    var chunky = { params: params, callback: callback };
 
     chunky.callback = chunky.callback || function( err ) { if( err ) { throw new Error( err ); } };
 
@@ -536,7 +1224,7 @@ function queryRaw(connectionString, query, paramsOrCallback, callback) {
             return;
         }
 
-        readall(q, notify, ext, query, chunky.params, function (err, results, more) {
+        readall(q, notify, ext, query, chunky.params, objects, function (err, results, more) {
 
             if (err) {
                 connection.close();
@@ -571,6 +1259,34 @@ function queryRaw(connectionString, query, paramsOrCallback, callback) {
     return notify;
 }
 
+// a table-valued parameter of the user defined table type typeName (optionally schema qualified), to
+// pass in the params of a query.  rows is an array of rows, each an array of values in the order of the
+// type's columns, or an object of columns, each an array of values, which are taken in key order.
+function tvp(typeName, rows) {
+
+    validateParameters( [ { type: 'string', value: typeName, name: 'table type name' }], 'tvp' );
+
+    if( !Array.isArray( rows )) {
+
+        if( typeof rows != 'object' || rows == null ) {
+
+            throw new Error( "[msnodesql] Invalid rows passed to function tvp. Type should be array or object." );
+        }
+
+        var columns = Object.keys( rows );
+        var count = columns.length > 0 ? rows[columns[0]].length : 0;
+        var byRow = [];
+
+        for( var r = 0; r < count; ++r ) {
+            byRow.push( columns.map( function( name ) { return rows[name][r]; }));
+        }
+        rows = byRow;
+    }
+
+    return { tableType: typeName, rows: rows };
+}
+
 exports.open = open;
 exports.query = query; 
 exports.queryRaw = queryRaw;
+exports.tvp = tvp;
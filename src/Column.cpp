@@ -29,43 +29,47 @@ const int64_t MS_PER_MINUTE      = 60 * MS_PER_SECOND;
 const int64_t MS_PER_HOUR        = 60 * MS_PER_MINUTE;
 const int64_t MS_PER_DAY         = 24 * MS_PER_HOUR;
 
-inline bool is_leap_year( int64_t year )
+// days since Jan 1, 1970 of a date in the proleptic Gregorian calendar, in constant time.  Years are 
+// counted from March so the leap day is the last day of the year, in 400 year eras of 146097 days.  
+// From Howard Hinnant's days_from_civil.
+inline int64_t days_from_civil( int64_t year, int64_t month, int64_t day )
 {
-    return (( year % 4 == 0 ) && ( year % 100 != 0 ) || ( year % 400 ) == 0 );
-}
+    year -= month <= 2;
+    int64_t era = ( year >= 0 ? year : year - 399 ) / 400;
+    int64_t year_of_era = year - era * 400;                                             // [0, 399]
+    int64_t day_of_year = ( 153 * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;  // [0, 365]
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;   // [0, 146096]
 
+    return era * 146097 + day_of_era - 719468;
 }
 
-// return the number of days since Jan 1, 1970
-double TimestampColumn::DaysSinceEpoch( SQLSMALLINT y, SQLUSMALLINT m, SQLUSMALLINT d )
+// the inverse of days_from_civil
+inline void civil_from_days( int64_t days, int64_t& year, int64_t& month, int64_t& day )
 {
-    // table derived from ECMA 262 15.9.1.4
-    static const double days_in_months[] = { 0.0, 31.0, 59.0, 90.0, 120.0, 151.0, 181.0, 212.0, 243.0, 273.0, 304.0, 334.0 };
-
-    double days;
-
-    // calculate the number of days to the start of the year
-    days = 365.0 * (y-1970.0) + floor((y-1969.0)/4.0) - floor((y-1901.0)/100.0) + floor((y-1601.0)/400.0);
-
-    // add in the number of days from the month
-    days += days_in_months[ m - 1 ];
-
-    // and finally add in the day from the date to the number of days elapsed
-    days += d - 1.0;
+    days += 719468;
+    int64_t era = ( days >= 0 ? days : days - 146096 ) / 146097;
+    int64_t day_of_era = days - era * 146097;                                           // [0, 146096]
+    int64_t year_of_era = ( day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096 ) / 365;
+    int64_t day_of_year = day_of_era - ( 365 * year_of_era + year_of_era / 4 - year_of_era / 100 );
+    int64_t month_from_march = ( 5 * day_of_year + 2 ) / 153;                           // [0, 11]
+
+    day = day_of_year - ( 153 * month_from_march + 2 ) / 5 + 1;
+    month = month_from_march < 10 ? month_from_march + 3 : month_from_march - 9;
+    year = year_of_era + era * 400 + ( month <= 2 );
+}
 
-    // account for leap year this year (affects days after Feb. 29)
-    if( is_leap_year( y ) && m > 2 ) {
-        days += 1.0;
-    }
+}
 
-    return (double) floor( days );
+// return the number of days since Jan 1, 1970
+int64_t TimestampColumn::DaysSinceEpoch( SQLSMALLINT y, SQLUSMALLINT m, SQLUSMALLINT d )
+{
+    return days_from_civil( y, m, d );
 }
 
 // derived from ECMA 262 15.9
 void TimestampColumn::MillisecondsFromDate( SQL_SS_TIMESTAMPOFFSET_STRUCT const& timeStruct )
 {
-    double ms = DaysSinceEpoch( timeStruct.year, timeStruct.month, timeStruct.day );
-    ms *= MS_PER_DAY;
+    int64_t ms = DaysSinceEpoch( timeStruct.year, timeStruct.month, timeStruct.day ) * MS_PER_DAY;
 
     // add in the hour, day minute, second and millisecond
     ms += timeStruct.hour * MS_PER_HOUR + timeStruct.minute * MS_PER_MINUTE + timeStruct.second * MS_PER_SECOND;
@@ -75,61 +79,15 @@ void TimestampColumn::MillisecondsFromDate( SQL_SS_TIMESTAMPOFFSET_STRUCT const&
     ms += timeStruct.timezone_hour * MS_PER_HOUR;
     ms += timeStruct.timezone_minute * MS_PER_MINUTE;
 
-    milliseconds = ms;
+    milliseconds = static_cast<double>( ms );
 
     nanoseconds_delta = timeStruct.fraction % NANOSECONDS_PER_MS;
 }
 
-int64_t TimestampColumn::YearFromDay( int64_t& day )
-{
-    int64_t year = 1970;
-    int64_t days_in_year = 365;
-    
-    if( day >= 0 ) {
-        while( day >= days_in_year ) {
-
-            day -= days_in_year;
-            ++year;
-            if( is_leap_year( year )) {
-                days_in_year = 366;
-            }
-            else {
-                days_in_year = 365;
-            }
-        }
-    }
-    else {
-
-        while( day <= -days_in_year ) {
-
-            day += days_in_year;
-            --year;
-            if( is_leap_year( year - 1 )) {
-                days_in_year = 366;
-            }
-            else {
-                days_in_year = 365;
-            }
-        }
-
-        if( day < 0 ) {
-            --year;
-            day += days_in_year;
-        }
-	}
-
-    return year;
-}
-
 // calculate the individual components of a date from the total milliseconds
 // since Jan 1, 1970.  Dates before 1970 are represented as negative numbers.
 void TimestampColumn::DateFromMilliseconds( SQL_SS_TIMESTAMPOFFSET_STRUCT& date )
 {
-    static const int64_t days_in_months[] =      { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-    static const int64_t leap_days_in_months[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-
-    int64_t const* start_days = days_in_months;
-
     // calculate the number of days elapsed (normalized from the beginning of supported datetime)
     int64_t day = static_cast<int64_t>( milliseconds ) / MS_PER_DAY;
     // calculate time portion of the timestamp
@@ -139,25 +97,12 @@ void TimestampColumn::DateFromMilliseconds( SQL_SS_TIMESTAMPOFFSET_STRUCT& date
         --day;
     }
 
-    // how many leap years have passed since that time?
-    int64_t year = YearFromDay( day );
-
-    if( is_leap_year( year )) {
-        start_days = leap_days_in_months;
-    }
-    
-
-    int64_t month = 0;
-    while( day >= start_days[ month ] ) {
-        day -= start_days[ month ];
-        ++month;
-    }
-    assert( month >= 0 && month <= 11 );
-    assert( day >= 0 && day <= 30 );
+    int64_t year, month;
+    civil_from_days( day, year, month, day );
 
     date.year = static_cast<SQLSMALLINT>( year );
-    date.month = static_cast<SQLUSMALLINT>( month + 1 );
-    date.day = static_cast<SQLUSMALLINT>( day + 1 );
+    date.month = static_cast<SQLUSMALLINT>( month );
+    date.day = static_cast<SQLUSMALLINT>( day );
 
     // SQL Server has 100 nanosecond resolution, so we adjust the milliseconds to high bits
     date.hour = time / MS_PER_HOUR;
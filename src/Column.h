@@ -30,104 +30,6 @@ namespace mssql
         virtual bool More() const { return false; }
     };
 
-    class StringColumn : public Column
-    {
-    public:
-
-        typedef std::vector<uint16_t> StringValue;
-
-        StringColumn( unique_ptr<StringValue>& text, bool more ) :
-            more(more) 
-        {
-            swap( this->text, text );
-        }
-
-        Handle<Value> ToValue()
-        {
-            HandleScope scope;
-
-            return scope.Close(String::New( text->data(), text->size() ));
-        }
-
-        bool More() const { return more; }
-
-    private:
-
-        unique_ptr<StringValue> text;
-        bool more;
-    };
-    
-    class BinaryColumn : public Column
-    {
-    public:
-        BinaryColumn(vector<char>& src, bool more)
-            : more(more)
-        {
-            buffer = move(src);
-        }
-        Handle<Value> ToValue()
-        {
-            HandleScope scope;
-            
-            int length = buffer.size();
-
-            char* destination = new char[length];
-
-            memcpy(destination, buffer.data(), length);
-
-            return scope.Close(node::Buffer::New(destination, length, deleteBuffer, nullptr)->handle_);
-        }
-        bool More() const { return more; }
-        
-        static void deleteBuffer(char* ptr, void* hint)
-        {
-            delete[] ptr;
-        }
-
-    private:
-        vector<char> buffer;
-        bool more;
-    };
-
-    class IntColumn : public Column
-    {
-    public:
-        IntColumn(long value) : value(value) {}
-        Handle<Value> ToValue()
-        {
-            HandleScope scope;
-            return scope.Close(Integer::New(value));
-        }
-
-    private:
-       int value;
-    };
-
-    class NullColumn : public Column
-    {
-    public:
-       Handle<Value> ToValue()
-       {
-           HandleScope scope;
-           return scope.Close(Null());
-       }
-    };
-
-    class NumberColumn : public Column
-    {
-    public:
-        NumberColumn(double value) : value(value) {}
-        Handle<Value> ToValue()
-
-        {
-           HandleScope scope;
-           return scope.Close(Number::New(value));
-        }
-
-    private:
-        double value;
-    };
-
     // Timestamps return dates in UTC timezone
     class TimestampColumn : public Column 
     {
@@ -157,6 +59,16 @@ namespace mssql
             return scope.Close( date );
         }
 
+        double Milliseconds() const
+        {
+            return milliseconds;
+        }
+
+        int32_t NanosecondsDelta() const
+        {
+            return nanoseconds_delta;
+        }
+
         void ToTimestampOffset( SQL_SS_TIMESTAMPOFFSET_STRUCT& date )
         {
             DateFromMilliseconds( date );
@@ -170,30 +82,14 @@ namespace mssql
         int32_t nanoseconds_delta;    // just the fractional part of the time passed in, not since epoch time
 
         // return the number of days since Jan 1, 1970
-        double DaysSinceEpoch( SQLSMALLINT y, SQLUSMALLINT m, SQLUSMALLINT d );
+        int64_t DaysSinceEpoch( SQLSMALLINT y, SQLUSMALLINT m, SQLUSMALLINT d );
 
         // derived from ECMA 262 15.9
         void MillisecondsFromDate( SQL_SS_TIMESTAMPOFFSET_STRUCT const& timeStruct );
 
-        // return the year from the epoch time.  The remainder is returned in the day parameter
-        int64_t YearFromDay( int64_t& day );
-
         // calculate the individual components of a date from the total milliseconds
         // since Jan 1, 1970
         void DateFromMilliseconds( SQL_SS_TIMESTAMPOFFSET_STRUCT& date );
     };
 
-    class BoolColumn : public Column
-    {
-    public:
-        BoolColumn( bool value) : value(value) {}
-        Handle<Value> ToValue()
-        {
-            HandleScope scope;
-            return scope.Close(Boolean::New(value));
-        }
-    private:
-        bool value;
-    };
-
 }   // namespace mssql
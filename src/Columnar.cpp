@@ -0,0 +1,208 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: Columnar.cpp
+// Contents: Columns of a result set stored contiguously by type to return as Javascript typed arrays
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Columnar.h"
+
+namespace mssql {
+
+namespace {
+
+// typed arrays are created through their global constructors and filled through their external storage
+Local<Object> NewTypedArray( const char* type, const void* values, size_t length, size_t element_size )
+{
+    HandleScope scope;
+
+    Local<Function> constructor = Context::GetCurrent()->Global()->Get( String::NewSymbol( type )).As<Function>();
+    Local<Value> argv[1] = { Integer::NewFromUnsigned( length ) };
+    Local<Object> array = constructor->NewInstance( 1, argv );
+
+    if( length > 0 ) {
+        memcpy( array->GetIndexedPropertiesExternalArrayData(), values, length * element_size );
+    }
+
+    return scope.Close( array );
+}
+
+template<typename T>
+Local<Object> NewTypedArray( const char* type, const vector<T>& values )
+{
+    return NewTypedArray( type, values.data(), values.size(), sizeof( T ));
+}
+
+}
+
+ColumnarColumn::Kind ColumnarColumn::KindFromType( SQLSMALLINT dataType )
+{
+    switch( dataType ) {
+    case SQL_BIT:
+        return Boolean;
+    case SQL_SMALLINT:
+    case SQL_TINYINT:
+    case SQL_INTEGER:
+        return Int32;
+    case SQL_DECIMAL:
+    case SQL_NUMERIC:
+    case SQL_REAL:
+    case SQL_FLOAT:
+    case SQL_DOUBLE:
+    case SQL_BIGINT:
+        return Number;
+    case SQL_TYPE_TIME:
+    case SQL_SS_TIME2:
+    case SQL_TYPE_TIMESTAMP:
+    case SQL_TYPE_DATE:
+    case SQL_SS_TIMESTAMPOFFSET:
+        return Date;
+    case SQL_BINARY:
+    case SQL_VARBINARY:
+    case SQL_LONGVARBINARY:
+    case SQL_SS_UDT:
+        return Binary;
+    default:
+        return Text;
+    }
+}
+
+void ColumnarColumn::NextRow( bool null )
+{
+    if( rows % 8 == 0 ) {
+        nulls.push_back( 0 );
+    }
+    if( null ) {
+        nulls.back() |= 1 << ( rows % 8 );
+    }
+    ++rows;
+}
+
+void ColumnarColumn::AppendNull( void )
+{
+    NextRow( true );
+
+    // keep a placeholder so the values stay at the index of their row
+    switch( kind ) {
+    case Boolean:
+        bools.push_back( 0 );
+        break;
+    case Int32:
+        ints.push_back( 0 );
+        break;
+    case Number:
+    case Date:
+        numbers.push_back( 0.0 );
+        break;
+    case Int64:
+        bigints.push_back( 0 );
+        break;
+    case Text:
+    case Binary:
+        offsets.push_back( offsets.back() );
+        break;
+    }
+}
+
+void ColumnarColumn::AppendBool( bool value )
+{
+    assert( kind == Boolean );
+    NextRow( false );
+    bools.push_back( value ? 1 : 0 );
+}
+
+void ColumnarColumn::AppendInt( int32_t value )
+{
+    assert( kind == Int32 );
+    NextRow( false );
+    ints.push_back( value );
+}
+
+void ColumnarColumn::AppendNumber( double value )
+{
+    assert( kind == Number || kind == Date );
+    NextRow( false );
+    numbers.push_back( value );
+}
+
+void ColumnarColumn::AppendInt64( int64_t value )
+{
+    assert( kind == Int64 );
+    NextRow( false );
+    bigints.push_back( value );
+}
+
+void ColumnarColumn::AppendBytes( const void* bytes, size_t length, bool more )
+{
+    assert( kind == Text || kind == Binary );
+
+    const char* begin = static_cast<const char*>( bytes );
+    data.insert( data.end(), begin, begin + length );
+
+    // continue the last value or start a new one
+    if( this->more ) {
+        offsets.back() = static_cast<int32_t>( data.size() );
+    }
+    else {
+        NextRow( false );
+        offsets.push_back( static_cast<int32_t>( data.size() ));
+    }
+
+    this->more = more;
+}
+
+Handle<Value> ColumnarColumn::ToValue( void )
+{
+    HandleScope scope;
+
+    Local<Object> column = Object::New();
+
+    switch( kind ) {
+    case Boolean:
+        column->Set( String::NewSymbol( "type" ), String::NewSymbol( "boolean" ));
+        column->Set( String::NewSymbol( "values" ), NewTypedArray( "Uint8Array", bools ));
+        break;
+    case Int32:
+        column->Set( String::NewSymbol( "type" ), String::NewSymbol( "int32" ));
+        column->Set( String::NewSymbol( "values" ), NewTypedArray( "Int32Array", ints ));
+        break;
+    case Number:
+        column->Set( String::NewSymbol( "type" ), String::NewSymbol( "number" ));
+        column->Set( String::NewSymbol( "values" ), NewTypedArray( "Float64Array", numbers ));
+        break;
+    case Int64:
+        // there are no 64 bit typed arrays, so each value is two int32s, little endian
+        column->Set( String::NewSymbol( "type" ), String::NewSymbol( "int64" ));
+        column->Set( String::NewSymbol( "values" ), NewTypedArray( "Int32Array", bigints.data(), bigints.size() * 2, sizeof( int32_t )));
+        break;
+    case Date:
+        column->Set( String::NewSymbol( "type" ), String::NewSymbol( "date" ));
+        column->Set( String::NewSymbol( "values" ), NewTypedArray( "Float64Array", numbers ));
+        break;
+    case Text:
+    case Binary:
+        column->Set( String::NewSymbol( "type" ), String::NewSymbol( kind == Text ? "text" : "binary" ));
+        column->Set( String::NewSymbol( "offsets" ), NewTypedArray( "Int32Array", offsets ));
+        column->Set( String::NewSymbol( "data" ), node::Buffer::New( data.data(), data.size() )->handle_ );
+        break;
+    }
+
+    column->Set( String::NewSymbol( "nulls" ), NewTypedArray( "Uint8Array", nulls ));
+
+    return scope.Close( column );
+}
+
+}   // namespace mssql
@@ -0,0 +1,87 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: Columnar.h
+// Contents: Columns of a result set stored contiguously by type to return as Javascript typed arrays
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+namespace mssql
+{
+    using namespace std;
+    using namespace v8;
+
+    // All the values of one column with a bitmap of which values are null.  Fixed width values are returned 
+    // as a typed array.  Strings (UTF-16) and binary values are returned as one Buffer with an array of the
+    // byte offset where each value starts.
+    class ColumnarColumn
+    {
+    public:
+
+        enum Kind
+        {
+            Boolean,
+            Int32,
+            Number,
+            Int64,      // returned as an Int32Array of the low then high half of each value
+            Date,       // milliseconds since Jan 1, 1970 UTC
+            Text,
+            Binary
+        };
+
+        explicit ColumnarColumn( Kind kind ) :
+            kind( kind ),
+            rows( 0 ),
+            more( false )
+        {
+            offsets.push_back( 0 );
+        }
+
+        static Kind KindFromType( SQLSMALLINT dataType );
+
+        void AppendNull( void );
+        void AppendBool( bool value );
+        void AppendInt( int32_t value );
+        void AppendNumber( double value );
+        void AppendInt64( int64_t value );
+
+        // LOB values are appended in pieces.  more is true when the next piece continues this value.
+        void AppendBytes( const void* bytes, size_t length, bool more );
+
+        size_t Rows( void ) const
+        {
+            return rows;
+        }
+
+        Handle<Value> ToValue( void );
+
+    private:
+
+        void NextRow( bool null );
+
+        Kind kind;
+        size_t rows;
+        bool more;                  // the last value appended continues in the next piece
+
+        vector<uint8_t> nulls;      // bit set for each null value
+        vector<uint8_t> bools;
+        vector<int32_t> ints;
+        vector<double> numbers;
+        vector<int64_t> bigints;
+        vector<int32_t> offsets;
+        vector<char> data;
+    };
+}
@@ -46,9 +46,17 @@ namespace mssql
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "close", Connection::Close);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "open", Connection::Open);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "query", Connection::Query);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "executeBatch", Connection::ExecuteBatch);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "bulkInit", Connection::BulkInit);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "bulkSend", Connection::BulkSend);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "bulkDone", Connection::BulkDone);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "readRow", Connection::ReadRow);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "readColumn", Connection::ReadColumn);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "readRowValues", Connection::ReadRowValues);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "readRows", Connection::ReadRows);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "readColumnar", Connection::ReadColumnar);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "readRowCount", Connection::ReadRowCount);
+        NODE_SET_PROTOTYPE_METHOD(constructor_template, "paramSignatures", Connection::ParamSignatures);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "beginTransaction", Connection::BeginTransaction);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "commit", Connection::Commit);
         NODE_SET_PROTOTYPE_METHOD(constructor_template, "rollback", Connection::Rollback);
@@ -128,11 +136,62 @@ namespace mssql
 
         Local<String> query = args[0].As<String>();
         Local<Array> params = args[1].As<Array>();
+        Local<Value> options = args[2];
+        Local<Object> callback = args[3].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->Query(query, params, options, callback));
+    }
+
+    Handle<Value> Connection::ExecuteBatch(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<String> query = args[0].As<String>();
+        Local<Array> rows = args[1].As<Array>();
+        Local<Object> callback = args[2].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->ExecuteBatch(query, rows, callback));
+    }
+
+    Handle<Value> Connection::BulkInit(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<String> table = args[0].As<String>();
+        Local<String> hints = args[1].As<String>();
         Local<Object> callback = args[2].As<Object>();
 
         Connection* connection = Unwrap<Connection>(args.This());
 
-        return scope.Close<Value>(connection->innerConnection->Query(query, params, callback));
+        return scope.Close<Value>(connection->innerConnection->BulkInit(table, hints, callback));
+    }
+
+    Handle<Value> Connection::BulkSend(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<Array> rows = args[0].As<Array>();
+        Local<Array> ordinals = args[1].As<Array>();
+        Local<Object> callback = args[2].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->BulkSend(rows, ordinals, callback));
+    }
+
+    Handle<Value> Connection::BulkDone(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<Object> callback = args[0].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->BulkDone(callback));
     }
     
     Handle<Value> Connection::ReadRow(const Arguments& args)
@@ -158,6 +217,41 @@ namespace mssql
         return scope.Close<Value>(connection->innerConnection->ReadColumn(column, callback));
     }
     
+    Handle<Value> Connection::ReadRowValues(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<Object> callback = args[0].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->ReadRowValues(callback));
+    }
+    
+    Handle<Value> Connection::ReadRows(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<Number> count = args[0].As<Number>();
+        bool objects = args[1]->BooleanValue();
+        Local<Object> callback = args[2].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->ReadRows(count, objects, callback));
+    }
+    
+    Handle<Value> Connection::ReadColumnar(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<Object> callback = args[0].As<Object>();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->ReadColumnar(callback));
+    }
+    
     Handle<Value> Connection::ReadNextResult(const Arguments& args)
     {
         HandleScope scope;
@@ -176,16 +270,28 @@ namespace mssql
         return connection->innerConnection->ReadRowCount();
     }
 
+    Handle<Value> Connection::ParamSignatures(const Arguments& args)
+    {
+        HandleScope scope;
+
+        Local<String> query = args[0]->ToString();
+
+        Connection* connection = Unwrap<Connection>(args.This());
+
+        return scope.Close<Value>(connection->innerConnection->ParamSignatures(query));
+    }
+
     Handle<Value> Connection::Open(const Arguments& args)
     {
         HandleScope scope;
 
         Local<String> connectionString = args[0].As<String>();
         Local<Object> callback = args[1].As<Object>();
+        bool bulkCopy = args[2]->BooleanValue();
 
         Connection* connection = Unwrap<Connection>(args.This());
 
-        return scope.Close<Value>(connection->innerConnection->Open(connectionString, callback, args.This()));
+        return scope.Close<Value>(connection->innerConnection->Open(connectionString, bulkCopy, callback, args.This()));
     }
 
 }
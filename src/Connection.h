@@ -49,10 +49,18 @@ namespace mssql
         static Handle<Value> New(const Arguments& args);
         static Handle<Value> Open(const Arguments& args);
         static Handle<Value> Query(const Arguments& args);
+        static Handle<Value> ExecuteBatch(const Arguments& args);
+        static Handle<Value> BulkInit(const Arguments& args);
+        static Handle<Value> BulkSend(const Arguments& args);
+        static Handle<Value> BulkDone(const Arguments& args);
         static Handle<Value> ReadRow(const Arguments& args);
         static Handle<Value> ReadColumn(const Arguments& args);
+        static Handle<Value> ReadRowValues(const Arguments& args);
+        static Handle<Value> ReadRows(const Arguments& args);
+        static Handle<Value> ReadColumnar(const Arguments& args);
         static Handle<Value> ReadNextResult(const Arguments& args);
         static Handle<Value> ReadRowCount(const Arguments& args);
+        static Handle<Value> ParamSignatures(const Arguments& args);
     };
 
 }
@@ -19,6 +19,9 @@
 
 #include "stdafx.h"
 #include "OdbcConnection.h"
+#include "Text.h"
+
+#include <sstream>
 
 #pragma intrinsic( memset )
 
@@ -33,6 +36,19 @@
 // boilerplate macro for checking for ODBC errors in this file
 #define CHECK_ODBC_ERROR( r, handle ) { if( !SQL_SUCCEEDED( r ) ) { RETURN_ODBC_ERROR( handle ); } }
 
+// boilerplate macro for checking calls on a descriptor of the statement, which records its own diagnostics.  The 
+// descriptor is freed with the statement.
+#define CHECK_DESC_ERROR( r, desc ) {                                       \
+    if( !SQL_SUCCEEDED( r ) ) {                                             \
+        error = LastDiagError( SQL_HANDLE_DESC, desc );                     \
+        statement.Free();                                                   \
+        return false;                                                       \
+    } }
+
+// boilerplate macro for checking the bcp_* functions, which report errors on the connection handle and so
+// must not free it
+#define CHECK_BCP_ERROR( r ) { if( r == FAIL ) { error = connection.LastError(); return false; } }
+
 // boilerplate macro for checking if SQL_NO_DATA was returned for field data
 #define CHECK_ODBC_NO_DATA( r, handle ) {                                                                 \
     if( r == SQL_NO_DATA ) {                                                                              \
@@ -53,8 +69,170 @@ namespace mssql
         // max characters within a (var)char field in SQL Server
         const int SQL_SERVER_MAX_STRING_SIZE = 8000;
 
-        // default size to retrieve from a LOB field and we don't know the size
+        // size of the first read of a LOB field when we don't know the size
         const int LOB_PACKET_SIZE = 8192;
+
+        // longest string (in characters) assembled from a LOB field in one piece, the most a JS string can hold
+        const SQLLEN STRING_MAX_LENGTH = ( 1 << 28 ) - 16;
+
+        // longest string column (in characters) that is bound when fetching a block of rows
+        const SQLULEN BOUND_STRING_MAX_SIZE = 256;
+
+        // limits on the number of rows and the total buffer size of a block of rows
+        const SQLULEN BLOCK_MAX_ROWS = 4096;
+        const SQLLEN BLOCK_BUFFER_SIZE = 1024 * 1024;
+
+        // largest binary value read in one piece, the most a node Buffer can hold
+        const SQLLEN BINARY_MAX_SIZE = 0x3fffffff;
+
+        // most distinct result sets whose column definitions are kept per connection
+        const size_t METADATA_CACHE_MAX_ENTRIES = 256;
+
+        // size of the buffer values are read into before they are written to a LOB sink
+        const SQLLEN LOB_SINK_BUFFER_SIZE = 1024 * 1024;
+
+        // types read as strings by TryReadString
+        bool IsStringType( SQLSMALLINT dataType )
+        {
+            switch( dataType ) {
+            case SQL_CHAR:
+            case SQL_VARCHAR:
+            case SQL_LONGVARCHAR:
+            case SQL_WCHAR:
+            case SQL_WVARCHAR:
+            case SQL_WLONGVARCHAR:
+            case SQL_SS_XML:
+            case SQL_GUID:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        // types read as SQL_NUMERIC_STRUCT with the decimal: 'string' query option
+        bool IsNumericType( SQLSMALLINT dataType )
+        {
+            return dataType == SQL_DECIMAL || dataType == SQL_NUMERIC;
+        }
+
+        // types that may be read as SQL_C_CHAR with the narrowVarchar query option
+        bool IsVarcharType( SQLSMALLINT dataType )
+        {
+            return dataType == SQL_CHAR || dataType == SQL_VARCHAR;
+        }
+
+        // types whose values may be written to a LOB sink
+        bool IsSinkType( SQLSMALLINT dataType )
+        {
+            switch( dataType ) {
+            case SQL_BINARY:
+            case SQL_VARBINARY:
+            case SQL_LONGVARBINARY:
+                return true;
+            default:
+                return IsStringType( dataType );
+            }
+        }
+
+        // the bcp program variable type of the values of a column laid out by ParamArray
+        int BulkType( ParamArray::ParamColumn const& column )
+        {
+            switch( column.c_type ) {
+            case SQL_C_WCHAR:
+                return SQLNCHAR;
+            case SQL_C_BIT:
+                return SQLBIT;
+            case SQL_C_SLONG:
+                return SQLINT4;
+            case SQL_C_SBIGINT:
+                return SQLINT8;
+            case SQL_C_DOUBLE:
+                return SQLFLT8;
+            case SQL_C_BINARY:
+                return column.sql_type == SQL_SS_TIMESTAMPOFFSET ? SQLDATETIMEOFFSETN : SQLBIGVARBINARY;
+            default:
+                // a column of only nulls
+                return SQLCHARACTER;
+            }
+        }
+
+        // types whose length bcp takes from bcp_collen rather than from the type
+        bool IsVariableBulkType( int bulkType )
+        {
+            return bulkType == SQLNCHAR || bulkType == SQLBIGVARBINARY;
+        }
+
+        // the bcp_* functions are exported only by the Native Client driver, so rather than linking its import 
+        // library they are looked up in the driver the first time a connection is opened for bulk loading
+        struct BulkCopyFunctions {
+            RETCODE (SQL_API *initW)( HDBC, LPCWSTR, LPCWSTR, LPCWSTR, INT );
+            RETCODE (SQL_API *control)( HDBC, INT, void* );
+            RETCODE (SQL_API *bind)( HDBC, LPCBYTE, INT, DBINT, LPCBYTE, INT, INT, INT );
+            RETCODE (SQL_API *colptr)( HDBC, LPCBYTE, INT );
+            RETCODE (SQL_API *collen)( HDBC, DBINT, INT );
+            RETCODE (SQL_API *sendrow)( HDBC );
+            DBINT (SQL_API *batch)( HDBC );
+            DBINT (SQL_API *done)( HDBC );
+        };
+
+        const wchar_t BULK_COPY_DRIVER[] = L"sqlncli11.dll";
+
+        BulkCopyFunctions bcp;
+        bool bcpLoaded = false;
+        CriticalSection bcpCriticalSection;
+
+        template<typename F>
+        bool FindBulkCopyFunction( HMODULE driver, const char* name, F& f )
+        {
+            f = reinterpret_cast<F>( GetProcAddress( driver, name ));
+            return f != NULL;
+        }
+
+        bool LoadBulkCopyFunctions()
+        {
+            ScopedCriticalSectionLock lock( bcpCriticalSection );
+
+            if( bcpLoaded ) {
+                return true;
+            }
+
+            HMODULE driver = LoadLibraryW( BULK_COPY_DRIVER );
+            if( driver == NULL ) {
+                return false;
+            }
+
+            bcpLoaded = FindBulkCopyFunction( driver, "bcp_initW", bcp.initW ) &&
+                        FindBulkCopyFunction( driver, "bcp_control", bcp.control ) &&
+                        FindBulkCopyFunction( driver, "bcp_bind", bcp.bind ) &&
+                        FindBulkCopyFunction( driver, "bcp_colptr", bcp.colptr ) &&
+                        FindBulkCopyFunction( driver, "bcp_collen", bcp.collen ) &&
+                        FindBulkCopyFunction( driver, "bcp_sendrow", bcp.sendrow ) &&
+                        FindBulkCopyFunction( driver, "bcp_batch", bcp.batch ) &&
+                        FindBulkCopyFunction( driver, "bcp_done", bcp.done );
+
+            // once loaded the driver stays loaded for the life of the process, as the functions are kept
+            if( !bcpLoaded ) {
+                FreeLibrary( driver );
+            }
+
+            return bcpLoaded;
+        }
+
+        // time only values are returned as a date on SQL Server's default date
+        SQL_SS_TIMESTAMPOFFSET_STRUCT TimeToTimestamp( SQL_SS_TIME2_STRUCT const& time )
+        {
+            SQL_SS_TIMESTAMPOFFSET_STRUCT datetime;
+            memset( &datetime, 0, sizeof( datetime ));  // not necessary, but simple precaution
+            datetime.year = SQL_SERVER_DEFAULT_YEAR;
+            datetime.month = SQL_SERVER_DEFAULT_MONTH;
+            datetime.day = SQL_SERVER_DEFAULT_DAY;
+            datetime.hour = time.hour;
+            datetime.minute = time.minute;
+            datetime.second = time.second;
+            datetime.fraction = time.fraction;
+
+            return datetime;
+        }
     }
 
     OdbcEnvironmentHandle OdbcConnection::environment;
@@ -66,6 +244,14 @@ namespace mssql
         int current_param = 1;
         for( QueryOperation::param_bindings::iterator i = params.begin(); i != params.end(); ++i ) {
 
+            if( i->js_type == QueryOperation::ParamBinding::JS_TABLE ) {
+
+                if( !TryBindTableParam( current_param++, *i )) {
+                    return false;
+                }
+                continue;
+            }
+
             SQLRETURN r = SQLBindParameter( statement, current_param++, SQL_PARAM_INPUT, i->c_type, i->sql_type, i->param_size, 
                                             i->digits, i->buffer, i->buffer_len, &i->indptr );
             // no need to check for SQL_STILL_EXECUTING
@@ -75,6 +261,100 @@ namespace mssql
         return true;
     }
 
+    void OdbcConnection::CountParamSignature( const wstring& query, const QueryOperation::param_bindings& params )
+    {
+        if( params.empty() ) {
+            return;
+        }
+
+        // the declared type of each parameter.  A table-valued parameter is declared by its type, not its row count.
+        wstringstream signature;
+        for( QueryOperation::param_bindings::const_iterator i = params.begin(); i != params.end(); ++i ) {
+
+            signature << i->sql_type << L'(';
+            if( i->js_type == QueryOperation::ParamBinding::JS_TABLE ) {
+                signature << i->type_name;
+            }
+            else {
+                signature << i->param_size << L',' << i->digits;
+            }
+            signature << L')';
+        }
+
+        ScopedCriticalSectionLock lock( paramSignaturesCriticalSection );
+
+        // like the metadata cache, only the most recent distinct queries are counted
+        if( paramSignatures.size() >= METADATA_CACHE_MAX_ENTRIES && paramSignatures.find( query ) == paramSignatures.end() ) {
+            paramSignatures.clear();
+        }
+        paramSignatures[ query ].insert( signature.str() );
+    }
+
+    int OdbcConnection::ParamSignatureCount( const wstring& query ) const
+    {
+        ScopedCriticalSectionLock lock( paramSignaturesCriticalSection );
+
+        size_t count = 0;
+        for( map<wstring, set<wstring>>::const_iterator i = paramSignatures.begin(); i != paramSignatures.end(); ++i ) {
+            if( query.empty() || i->first == query ) {
+                count += i->second.size();
+            }
+        }
+
+        return static_cast<int>( count );
+    }
+
+    bool OdbcConnection::TryBindTableParam( SQLUSMALLINT param, QueryOperation::ParamBinding& binding )
+    {
+        SQLRETURN r = SQLBindParameter( statement, param, SQL_PARAM_INPUT, SQL_C_DEFAULT, SQL_SS_TABLE, binding.param_size, 0, 
+                                        NULL, 0, &binding.indptr );
+        CHECK_ODBC_ERROR( r, statement );
+
+        // the table type is named on the parameter's implementation descriptor, with its schema if one is given
+        SQLHDESC ipd;
+        r = SQLGetStmtAttr( statement, SQL_ATTR_IMP_PARAM_DESC, &ipd, 0, NULL );
+        CHECK_ODBC_ERROR( r, statement );
+
+        wstring schema;
+        wstring type = binding.type_name;
+        size_t dot = type.find( L'.' );
+        if( dot != wstring::npos ) {
+            schema = type.substr( 0, dot );
+            type = type.substr( dot + 1 );
+        }
+
+        r = SQLSetDescField( ipd, param, SQL_CA_SS_TYPE_NAME, const_cast<wchar_t*>( type.c_str() ), SQL_NTS );
+        CHECK_DESC_ERROR( r, ipd );
+        if( !schema.empty() ) {
+            r = SQLSetDescField( ipd, param, SQL_CA_SS_SCHEMA_NAME, const_cast<wchar_t*>( schema.c_str() ), SQL_NTS );
+            CHECK_DESC_ERROR( r, ipd );
+        }
+
+        // an empty table is sent as the parameter's default, with no columns bound
+        if( binding.table->rows == 0 ) {
+            return true;
+        }
+
+        // while the focus is on the table, parameters bound are its columns, each an array of every row's values
+        r = SQLSetStmtAttr( statement, SQL_SOPT_SS_PARAM_FOCUS, reinterpret_cast<SQLPOINTER>( static_cast<SQLULEN>( param )), 
+                            SQL_IS_INTEGER );
+        CHECK_ODBC_ERROR( r, statement );
+
+        SQLUSMALLINT tableColumn = 1;
+        for( ParamArray::param_columns::iterator c = binding.table->columns.begin(); c != binding.table->columns.end(); ++c ) {
+
+            assert( !c->Packed() );
+            r = SQLBindParameter( statement, tableColumn++, SQL_PARAM_INPUT, c->c_type, c->sql_type, c->param_size, 
+                                  c->digits, c->data.data(), c->element_size, c->indicators.data() );
+            CHECK_ODBC_ERROR( r, statement );
+        }
+
+        r = SQLSetStmtAttr( statement, SQL_SOPT_SS_PARAM_FOCUS, reinterpret_cast<SQLPOINTER>( 0 ), SQL_IS_INTEGER );
+        CHECK_ODBC_ERROR( r, statement );
+
+        return true;
+    }
+
     bool OdbcConnection::InitializeEnvironment()
     {
         SQLRETURN ret = SQLSetEnvAttr(NULL, SQL_ATTR_CONNECTION_POOLING, (SQLPOINTER)SQL_CP_ONE_PER_HENV, 0);
@@ -92,6 +372,11 @@ namespace mssql
 
     bool OdbcConnection::StartReadingResults()
     {
+        // the previous result set's arrays are released with it, so they must be unbound first
+        if( resultset && resultset->IsBlockCursor() ) {
+            UnbindColumns();
+        }
+
         SQLSMALLINT columns;
         SQLRETURN ret = SQLNumResultCols(statement, &columns);
         CHECK_ODBC_ERROR( ret, statement );
@@ -99,6 +384,93 @@ namespace mssql
         column = 0;
         resultset = make_shared<ResultSet>(columns);
 
+        bool reused = false;
+        if( !TryReuseMetadata( reused )) {
+            return false;
+        }
+        if( !reused && !TryDescribeColumns() ) {
+            return false;
+        }
+
+        resultset->MakePropertyNames();
+
+        columnReaders.resize( resultset->GetColumns() );
+        for( int c = 0; c < resultset->GetColumns(); ++c ) {
+            columnReaders[ c ] = ReaderForType( resultset->GetMetadata( c ).dataType );
+        }
+        if( lobSinkColumn >= 0 && lobSinkColumn < resultset->GetColumns() ) {
+
+            const ResultSet::ColumnDefinition& sink = resultset->GetMetadata( lobSinkColumn );
+            if( !sink.lob || !IsSinkType( sink.dataType )) {
+                CloseLobSink();
+                error = make_shared<OdbcError>( OdbcError::NODE_LOB_SINK_COLUMN );
+                statement.Free();
+                return false;
+            }
+            columnReaders[ lobSinkColumn ] = &OdbcConnection::TryReadSinkColumn;
+        }
+
+        if( !TryBindColumns() ) {
+            return false;
+        }
+
+        if( !TryPrepareNumericColumns() ) {
+            return false;
+        }
+
+        ret = SQLRowCount(statement, &resultset->rowcount);
+        CHECK_ODBC_ERROR( ret, statement );
+
+        return true;
+    }
+
+    // use the column definitions from the last time this query's result set was read if its columns 
+    // still have the same types and strings the same sizes
+    bool OdbcConnection::TryReuseMetadata( bool& reused )
+    {
+        reused = false;
+
+        MetadataCache::const_iterator cached = metadataCache.find( make_pair( currentQuery, resultOrdinal ));
+        if( cached == metadataCache.end() || static_cast<int>( cached->second.size() ) != resultset->GetColumns() ) {
+            return true;
+        }
+
+        for( int c = 0; c < resultset->GetColumns(); ++c ) {
+
+            SQLLEN dataType = 0;
+            SQLRETURN ret = SQLColAttribute( statement, c + 1, SQL_DESC_CONCISE_TYPE, NULL, 0, NULL, &dataType );
+            CHECK_ODBC_ERROR( ret, statement );
+
+            if( dataType != cached->second[ c ].dataType ) {
+                return true;
+            }
+
+            // strings are read into buffers sized for their display size, and it marks string and binary LOBs, 
+            // so that must match too
+            if( IsSinkType( cached->second[ c ].dataType )) {
+
+                SQLLEN displaySize = 0;
+                ret = SQLColAttribute( statement, c + 1, SQL_DESC_DISPLAY_SIZE, NULL, 0, NULL, &displaySize );
+                CHECK_ODBC_ERROR( ret, statement );
+
+                if( displaySize != cached->second[ c ].displaySize ) {
+                    return true;
+                }
+            }
+        }
+
+        resultset->metadata = cached->second;
+        reused = true;
+
+        return true;
+    }
+
+    // describe each column of the current result set and remember the definitions for the next time 
+    // the query is run
+    bool OdbcConnection::TryDescribeColumns()
+    {
+        SQLRETURN ret;
+
         while (column < resultset->GetColumns())
         {
             SQLSMALLINT nameLength;
@@ -127,15 +499,187 @@ namespace mssql
                 current.udtTypeName = wstring(udtTypeName, udtTypeNameLen );
             }
 
+            // binary columns are described too, so varbinary(max) is known to be a LOB for the lobSink option
+            if( IsSinkType( current.dataType )) {
+                ret = SQLColAttribute( statement, column + 1, SQL_DESC_DISPLAY_SIZE, NULL, 0, NULL, &current.displaySize );
+                CHECK_ODBC_ERROR( ret, statement );
+
+                // when a field type is LOB, we read a packet at time and pass that back.
+                current.lob = current.displaySize == 0 || current.displaySize == std::numeric_limits<int>::max() || 
+                              current.displaySize == std::numeric_limits<int>::max() >> 1 || 
+                              current.displaySize == std::numeric_limits<unsigned long>::max() - 1;
+            }
+
             column++;
         }
 
-        ret = SQLRowCount(statement, &resultset->rowcount);
+        // an application running many different queries just starts the cache again when it fills
+        if( metadataCache.size() >= METADATA_CACHE_MAX_ENTRIES ) {
+            metadataCache.clear();
+        }
+        metadataCache[ make_pair( currentQuery, resultOrdinal ) ] = resultset->metadata;
+
+        return true;
+    }
+
+    // Bind every column to a column-wise array and fetch many rows with each SQLFetch.  This is only done
+    // when all the columns are fixed width (or short strings) since the driver doesn't support SQLGetData
+    // with a block cursor.  Result sets with LOB columns are read a row at a time with SQLGetData.
+    bool OdbcConnection::TryBindColumns()
+    {
+        vector<ResultSet::BoundColumn> bound( resultset->GetColumns() );
+        SQLLEN rowSize = 0;
+
+        for( int c = 0; c < resultset->GetColumns(); ++c ) {
+
+            const ResultSet::ColumnDefinition& definition = resultset->GetMetadata( c );
+            ResultSet::BoundColumn& current = bound[ c ];
+
+            // the LOB sink column is read with SQLGetData
+            if( c == lobSinkColumn && definition.lob ) {
+                return true;
+            }
+
+            switch( definition.dataType ) {
+            case SQL_BIT:
+            case SQL_SMALLINT:
+            case SQL_TINYINT:
+            case SQL_INTEGER:
+                current.cType = SQL_C_SLONG;
+                current.elementSize = sizeof( long );
+                break;
+            case SQL_DECIMAL:
+            case SQL_NUMERIC:
+                if( decimalAsString ) {
+                    current.cType = SQL_C_NUMERIC;
+                    current.elementSize = sizeof( SQL_NUMERIC_STRUCT );
+                    break;
+                }
+                current.cType = SQL_C_DOUBLE;
+                current.elementSize = sizeof( double );
+                break;
+            case SQL_REAL:
+            case SQL_FLOAT:
+            case SQL_DOUBLE:
+                current.cType = SQL_C_DOUBLE;
+                current.elementSize = sizeof( double );
+                break;
+            case SQL_BIGINT:
+                current.cType = SQL_C_SBIGINT;
+                current.elementSize = sizeof( int64_t );
+                break;
+            case SQL_TYPE_TIMESTAMP:
+            case SQL_TYPE_DATE:
+            case SQL_SS_TIMESTAMPOFFSET:
+                current.cType = SQL_C_SS_TIMESTAMPOFFSET;
+                current.elementSize = sizeof( SQL_SS_TIMESTAMPOFFSET_STRUCT );
+                break;
+            case SQL_TYPE_TIME:
+            case SQL_SS_TIME2:
+                current.cType = SQL_C_SS_TIME2;
+                current.elementSize = sizeof( SQL_SS_TIME2_STRUCT );
+                break;
+            case SQL_CHAR:
+            case SQL_VARCHAR:
+            case SQL_WCHAR:
+            case SQL_WVARCHAR:
+            case SQL_GUID:
+                // (max) columns report a size of 0
+                if( definition.columnSize == 0 || definition.columnSize > BOUND_STRING_MAX_SIZE ) {
+                    return true;
+                }
+                if( narrowVarchar && IsVarcharType( definition.dataType )) {
+                    current.cType = SQL_C_CHAR;
+                    current.elementSize = definition.columnSize * 2 + 1;    // as read by TryReadString
+                    break;
+                }
+                current.cType = SQL_C_WCHAR;
+                current.elementSize = ( definition.columnSize + 1 ) * sizeof( uint16_t );
+                break;
+            default:
+                // LOB, binary and other types are read with SQLGetData
+                return true;
+            }
+
+            rowSize += current.elementSize + sizeof( SQLLEN );
+        }
+
+        if( rowSize == 0 ) {
+            return true;
+        }
+
+        SQLULEN rows = std::max<SQLULEN>( 1, std::min<SQLULEN>( BLOCK_MAX_ROWS, BLOCK_BUFFER_SIZE / rowSize ));
+
+        SQLRETURN ret = SQLSetStmtAttr( statement, SQL_ATTR_ROW_BIND_TYPE, reinterpret_cast<SQLPOINTER>( SQL_BIND_BY_COLUMN ), 0 );
+        CHECK_ODBC_ERROR( ret, statement );
+        ret = SQLSetStmtAttr( statement, SQL_ATTR_ROW_ARRAY_SIZE, reinterpret_cast<SQLPOINTER>( rows ), 0 );
+        CHECK_ODBC_ERROR( ret, statement );
+        ret = SQLSetStmtAttr( statement, SQL_ATTR_ROWS_FETCHED_PTR, &resultset->rowsFetched, 0 );
+        CHECK_ODBC_ERROR( ret, statement );
+
+        // the arrays are moved into the result set before binding so the bound addresses don't change
+        resultset->bound.swap( bound );
+
+        for( int c = 0; c < resultset->GetColumns(); ++c ) {
+
+            ResultSet::BoundColumn& current = resultset->bound[ c ];
+            current.data.resize( rows * current.elementSize );
+            current.indicators.resize( rows );
+
+            ret = SQLBindCol( statement, c + 1, current.cType, current.data.data(), current.elementSize, 
+                              current.indicators.data() );
+            CHECK_ODBC_ERROR( ret, statement );
+        }
+
+        return true;
+    }
+
+    // With decimal: 'string', decimal and numeric columns are read as SQL_NUMERIC_STRUCT.  The precision and
+    // scale to read them with are set on the application row descriptor, which SQLGetData uses when given 
+    // SQL_ARD_TYPE.  Setting them resets a bound column's data pointer, so that is set again after them.
+    bool OdbcConnection::TryPrepareNumericColumns()
+    {
+        if( !decimalAsString ) {
+            return true;
+        }
+
+        SQLHDESC ard = NULL;
+        SQLRETURN ret = SQLGetStmtAttr( statement, SQL_ATTR_APP_ROW_DESC, &ard, 0, NULL );
         CHECK_ODBC_ERROR( ret, statement );
 
+        for( int c = 0; c < resultset->GetColumns(); ++c ) {
+
+            const ResultSet::ColumnDefinition& definition = resultset->GetMetadata( c );
+            if( !IsNumericType( definition.dataType )) {
+                continue;
+            }
+
+            SQLSMALLINT record = static_cast<SQLSMALLINT>( c + 1 );
+            ret = SQLSetDescField( ard, record, SQL_DESC_TYPE, reinterpret_cast<SQLPOINTER>( SQL_C_NUMERIC ), 0 );
+            CHECK_ODBC_ERROR( ret, statement );
+            ret = SQLSetDescField( ard, record, SQL_DESC_PRECISION, reinterpret_cast<SQLPOINTER>( definition.columnSize ), 0 );
+            CHECK_ODBC_ERROR( ret, statement );
+            ret = SQLSetDescField( ard, record, SQL_DESC_SCALE, 
+                                   reinterpret_cast<SQLPOINTER>( static_cast<SQLLEN>( definition.decimalDigits )), 0 );
+            CHECK_ODBC_ERROR( ret, statement );
+
+            if( resultset->IsBlockCursor() ) {
+                ret = SQLSetDescField( ard, record, SQL_DESC_DATA_PTR, resultset->bound[ c ].data.data(), 0 );
+                CHECK_ODBC_ERROR( ret, statement );
+            }
+        }
+
         return true;
     }
 
+    // return the statement to fetching a row at a time with no bound columns
+    void OdbcConnection::UnbindColumns()
+    {
+        SQLFreeStmt( statement, SQL_UNBIND );
+        SQLSetStmtAttr( statement, SQL_ATTR_ROW_ARRAY_SIZE, reinterpret_cast<SQLPOINTER>( 1 ), 0 );
+        SQLSetStmtAttr( statement, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0 );
+    }
+
     bool OdbcConnection::TryClose()
     {
         if (connectionState != Closed)  // fast fail before critical section
@@ -143,11 +687,17 @@ namespace mssql
             ScopedCriticalSectionLock critSecLock( closeCriticalSection );
             if (connectionState != Closed)
             {
+                if( bulkLoading ) {
+                    bcp.done( connection );
+                    bulkLoading = false;
+                }
+
                 SQLDisconnect(connection);
 
                 resultset.reset();
                 statement.Free();
                 connection.Free();
+                CloseLobSink();
                 connectionState = Closed;
             }
         }
@@ -155,18 +705,30 @@ namespace mssql
         return true;
     }
 
-    bool OdbcConnection::TryOpen(const wstring& connectionString)
+    bool OdbcConnection::TryOpen(const wstring& connectionString, bool bulkCopy)
     {
         SQLRETURN ret;
 
         assert(connectionState == Closed );
 
+        if( bulkCopy && !LoadBulkCopyFunctions() ) {
+            error = make_shared<OdbcError>( OdbcError::NODE_BCP_UNAVAILABLE );
+            return false;
+        }
+
         OdbcConnectionHandle localConnection;
 
         if( !localConnection.Alloc(environment) ) { RETURN_ODBC_ERROR( environment ); }
 
         this->connection = std::move(localConnection);
 
+        // bulk copy must be enabled before connecting, and only connections opened for conn.bulkLoad pay for it
+        if( bulkCopy ) {
+            ret = SQLSetConnectAttr( connection, SQL_COPT_SS_BCP, reinterpret_cast<SQLPOINTER>( SQL_BCP_ON ), SQL_IS_INTEGER );
+            CHECK_ODBC_ERROR( ret, connection );
+        }
+        this->bulkCopy = bulkCopy;
+
         ret = SQLDriverConnect(connection, NULL, const_cast<wchar_t*>(connectionString.c_str()), connectionString.length(), NULL, 0, NULL, SQL_DRIVER_NOPROMPT);
         CHECK_ODBC_ERROR( ret, connection );
 
@@ -174,10 +736,42 @@ namespace mssql
         return true;
     }
 
-    bool OdbcConnection::TryExecute( const wstring& query, QueryOperation::param_bindings& paramIt )
+    bool OdbcConnection::TryExecute( const wstring& query, QueryOperation::param_bindings& paramIt, const QueryOptions& options )
     {
         assert( connectionState == Open );
 
+        prefetchDepth = options.prefetch;
+        lobChunkSize = options.lobChunkSize;
+        narrowVarchar = options.narrowVarchar;
+        bigintAsString = options.bigintAsString;
+        decimalAsString = options.decimalAsString;
+
+        switch( options.dates ) {
+        case QueryOptions::PlainDates:
+            dateCell = ResultSet::Cell::PlainDate;
+            break;
+        case QueryOptions::NumberDates:
+            dateCell = ResultSet::Cell::Number;
+            break;
+        default:
+            dateCell = ResultSet::Cell::Date;
+            break;
+        }
+
+        CloseLobSink();
+        lobSinkColumn = options.lobSinkColumn;
+        if( lobSinkColumn >= 0 ) {
+
+            lobSink = CreateFileW( options.lobSinkPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 
+                                   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+            if( lobSink == INVALID_HANDLE_VALUE ) {
+                lobSinkColumn = -1;
+                error = make_shared<OdbcError>( OdbcError::NODE_LOB_SINK_OPEN );
+                return false;
+            }
+            lobSinkBuffer.resize( LOB_SINK_BUFFER_SIZE );
+        }
+
         // if the statement isn't already allocated
         if( !statement )
         {
@@ -191,9 +785,12 @@ namespace mssql
             // error already set in BindParams
             return false;
         }
+        CountParamSignature( query, paramIt );
 
         endOfResults = true;     // reset 
         column = 0;
+        currentQuery = query;
+        resultOrdinal = 0;
 
         SQLRETURN ret = SQLExecDirect(statement, const_cast<wchar_t*>(query.c_str()), query.length());
         if (ret != SQL_NO_DATA && !SQL_SUCCEEDED(ret)) 
@@ -206,270 +803,978 @@ namespace mssql
         return StartReadingResults();
     }
 
-    bool OdbcConnection::TryReadRow()
+    bool OdbcConnection::TryExecuteBatch( const wstring& query, ParamArray::param_columns& columns, SQLULEN rows, 
+                                          SQLUSMALLINT* status, SQLLEN& rowcount )
     {
-        column = 0; // reset
+        assert( connectionState == Open );
 
-        SQLRETURN ret = SQLFetch(statement);
-        if (ret == SQL_NO_DATA) 
-        { 
-            resultset->endOfRows = true;
-            return true;
-        }
-        else 
+        CloseLobSink();
+
+        // if the statement isn't already allocated
+        if( !statement )
         {
-            resultset->endOfRows = false;
+            // allocate it
+            if( !statement.Alloc(connection) ) { RETURN_ODBC_ERROR( connection ); }
         }
+
+        // a batch returns no rows, only the rows affected by all its parameter sets
+        resultset = make_shared<ResultSet>(0);
+        resultset->endOfRows = true;
+        endOfResults = true;
+        column = 0;
+        currentQuery = query;
+        resultOrdinal = 0;
+
+        SQLRETURN ret = SQLSetStmtAttr( statement, SQL_ATTR_PARAM_BIND_TYPE, reinterpret_cast<SQLPOINTER>( SQL_PARAM_BIND_BY_COLUMN ), 0 );
+        CHECK_ODBC_ERROR( ret, statement );
+        ret = SQLSetStmtAttr( statement, SQL_ATTR_PARAMSET_SIZE, reinterpret_cast<SQLPOINTER>( rows ), 0 );
+        CHECK_ODBC_ERROR( ret, statement );
+        ret = SQLSetStmtAttr( statement, SQL_ATTR_PARAM_STATUS_PTR, status, 0 );
         CHECK_ODBC_ERROR( ret, statement );
 
-        return true;
-    }
+        // a packed column is sent a value at a time at execution.  Its offsets are bound in place of its values, so 
+        // the address SQLParamData returns for a value is that of the row's offset.
+        vector<vector<SQLLEN>> atExec( columns.size() );
+        int current_param = 1;
+        for( size_t c = 0; c < columns.size(); ++c ) {
 
-    bool OdbcConnection::TryReadColumn(int column)
-    {
-        assert( column >= 0 && column < resultset->GetColumns() );
+            ParamArray::ParamColumn& paramColumn = columns[ c ];
+            if( paramColumn.Packed() ) {
 
-        SQLLEN strLen_or_IndPtr;
-        const ResultSet::ColumnDefinition& definition = resultset->GetMetadata(column);
-        switch (definition.dataType)
-        {
-        case SQL_CHAR:
-        case SQL_VARCHAR:
-        case SQL_LONGVARCHAR:
-        case SQL_WCHAR:
-        case SQL_WVARCHAR:
-        case SQL_WLONGVARCHAR:
-        case SQL_SS_XML:
-        case SQL_GUID:
-            {
-                bool read = TryReadString( false, column );
-                if( !read ) {
-                    return false;
+                atExec[ c ].resize( rows );
+                for( SQLULEN r = 0; r < rows; ++r ) {
+                    SQLLEN length = paramColumn.indicators[ r ];
+                    atExec[ c ][ r ] = length == SQL_NULL_DATA ? SQL_NULL_DATA : SQL_LEN_DATA_AT_EXEC( length );
                 }
+                ret = SQLBindParameter( statement, current_param++, SQL_PARAM_INPUT, paramColumn.c_type, 
+                                        paramColumn.sql_type, paramColumn.param_size, paramColumn.digits, 
+                                        paramColumn.offsets.data(), sizeof( size_t ), atExec[ c ].data() );
             }
-            break;
-        case SQL_BIT:
-            {
-                long val;
-                SQLRETURN ret = SQLGetData(statement, column + 1, SQL_C_SLONG, &val, sizeof(val), &strLen_or_IndPtr);
+            else {
+
+                ret = SQLBindParameter( statement, current_param++, SQL_PARAM_INPUT, paramColumn.c_type, 
+                                        paramColumn.sql_type, paramColumn.param_size, paramColumn.digits, 
+                                        paramColumn.data.data(), paramColumn.element_size, paramColumn.indicators.data() );
+            }
+            CHECK_ODBC_ERROR( ret, statement );
+        }
+
+        // the driver only fails the whole execution when every parameter set fails, otherwise the failures are in status
+        ret = SQLExecDirect(statement, const_cast<wchar_t*>(query.c_str()), query.length());
+        while( ret == SQL_NEED_DATA ) {
+
+            SQLPOINTER token = NULL;
+            ret = SQLParamData( statement, &token );
+            if( ret != SQL_NEED_DATA ) {
+                break;
+            }
+
+            size_t* offset = static_cast<size_t*>( token );
+            ParamArray::param_columns::iterator packed = columns.begin();
+            while( packed != columns.end() && 
+                   !( packed->Packed() && offset >= packed->offsets.data() && offset < packed->offsets.data() + rows )) {
+                ++packed;
+            }
+            assert( packed != columns.end() );
+
+            SQLULEN row = offset - packed->offsets.data();
+            ret = SQLPutData( statement, packed->Value( row ), packed->indicators[ row ] );
+            CHECK_ODBC_ERROR( ret, statement );
+            ret = SQL_NEED_DATA;
+        }
+        if( ret == SQL_INVALID_HANDLE ) {
+            error = make_shared<OdbcError>( OdbcError::NODE_SQL_INVALID_HANDLE );
+            statement.Free();
+            return false;
+        }
+        if (ret != SQL_NO_DATA && !SQL_SUCCEEDED(ret)) 
+        { 
+            RETURN_ODBC_ERROR( statement );
+        }
+
+        // a failed result is only skipped when it belongs to a parameter set the driver marked as failed
+        bool paramSetErrors = false;
+        for( SQLULEN r = 0; r < rows; ++r ) {
+            if( status[r] == SQL_PARAM_ERROR ) {
+                paramSetErrors = true;
+                break;
+            }
+        }
+
+        // each parameter set reports its rows affected as a separate result.  A result that failed has no count
+        // but SQLMoreResults still moves past it.  There is at most one result per parameter set, so the loop
+        // stops there even if the driver keeps returning results.
+        rowcount = 0;
+        for( SQLULEN results = 0; ret != SQL_NO_DATA && results < rows; ++results ) {
+
+            if( ret == SQL_INVALID_HANDLE ) {
+                error = make_shared<OdbcError>( OdbcError::NODE_SQL_INVALID_HANDLE );
+                statement.Free();
+                return false;
+            }
+
+            if( !SQL_SUCCEEDED( ret ) && !paramSetErrors ) {
+                RETURN_ODBC_ERROR( statement );
+            }
+
+            if( SQL_SUCCEEDED( ret )) {
+
+                SQLLEN affected = 0;
+                ret = SQLRowCount( statement, &affected );
                 CHECK_ODBC_ERROR( ret, statement );
-                if (strLen_or_IndPtr == SQL_NULL_DATA) 
-                {
-                    resultset->SetColumn(make_shared<NullColumn>());
+                if( affected > 0 ) {
+                    rowcount += affected;
                 }
-                else 
-                {
-                    resultset->SetColumn(make_shared<BoolColumn>((val != 0) ? true : false));
+            }
+
+            ret = SQLMoreResults( statement );
+        }
+        if( ret == SQL_ERROR && !paramSetErrors ) {
+            RETURN_ODBC_ERROR( statement );
+        }
+        resultset->rowcount = rowcount;
+
+        // the parameter array attributes stay with the handle, so the next query gets a fresh one
+        statement.Free();
+
+        return true;
+    }
+
+    bool OdbcConnection::TryBulkInit( const wstring& table, const wstring& hints )
+    {
+        assert( connectionState == Open );
+        assert( !bulkLoading );
+
+        if( !bulkCopy ) {
+            error = make_shared<OdbcError>( OdbcError::NODE_BCP_NOT_ENABLED );
+            return false;
+        }
+
+        RETCODE ret = bcp.initW( connection, table.c_str(), NULL, NULL, DB_IN );
+        CHECK_BCP_ERROR( ret );
+        bulkLoading = true;
+
+        // a null value inserts null rather than the column default, as an INSERT would
+        ret = bcp.control( connection, BCPKEEPNULLS, reinterpret_cast<void*>( TRUE ));
+        if( ret != FAIL && !hints.empty() ) {
+            // TABLOCK by default, which lets the server minimally log the load into a heap or empty table
+            ret = bcp.control( connection, BCPHINTSW, const_cast<wchar_t*>( hints.c_str() ));
+        }
+        if( ret == FAIL ) {
+            error = connection.LastError();
+            bcp.done( connection );
+            bulkLoading = false;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool OdbcConnection::TryBulkSend( ParamArray::param_columns& columns, SQLULEN rows, const vector<int>& ordinals, 
+                                      DBINT& sent )
+    {
+        assert( bulkLoading );
+        assert( columns.size() == ordinals.size() );
+
+        // the columns are laid out for this batch alone, so they are bound again each time
+        vector<int> types( columns.size() );
+        for( size_t c = 0; c < columns.size(); ++c ) {
+
+            types[ c ] = BulkType( columns[ c ] );
+            RETCODE ret = bcp.bind( connection, reinterpret_cast<LPCBYTE>( columns[ c ].data.data() ), 0, SQL_VARLEN_DATA, 
+                                    NULL, 0, types[ c ], ordinals[ c ] );
+            CHECK_BCP_ERROR( ret );
+        }
+
+        for( SQLULEN r = 0; r < rows; ++r ) {
+
+            for( size_t c = 0; c < columns.size(); ++c ) {
+
+                ParamArray::ParamColumn& paramColumn = columns[ c ];
+                RETCODE ret = bcp.colptr( connection, reinterpret_cast<LPCBYTE>( paramColumn.Value( r )), ordinals[ c ] );
+                CHECK_BCP_ERROR( ret );
+
+                DBINT length = static_cast<DBINT>( paramColumn.indicators[ r ] );
+                if( length != SQL_NULL_DATA && !IsVariableBulkType( types[ c ] )) {
+                    length = SQL_VARLEN_DATA;
                 }
+                ret = bcp.collen( connection, length, ordinals[ c ] );
+                CHECK_BCP_ERROR( ret );
             }
-            break;
-        case SQL_SMALLINT:
-        case SQL_TINYINT:
-        case SQL_INTEGER:
+
+            RETCODE ret = bcp.sendrow( connection );
+            CHECK_BCP_ERROR( ret );
+        }
+
+        // commit the rows sent so a failure later in the load doesn't lose them
+        sent = bcp.batch( connection );
+        if( sent == -1 ) {
+            error = connection.LastError();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool OdbcConnection::TryBulkDone( DBINT& rowcount )
+    {
+        if( !bulkLoading ) {
+            rowcount = 0;
+            return true;
+        }
+
+        bulkLoading = false;
+        rowcount = bcp.done( connection );
+        if( rowcount == -1 ) {
+            error = connection.LastError();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool OdbcConnection::TryReadRow()
+    {
+        column = 0; // reset
+
+        // move to the next row of the block already fetched
+        if( resultset->IsBlockCursor() && resultset->blockRow + 1 < resultset->rowsFetched ) {
+            ++resultset->blockRow;
+            return true;
+        }
+
+        SQLRETURN ret = SQLFetch(statement);
+        if (ret == SQL_NO_DATA) 
+        { 
+            resultset->endOfRows = true;
+            return true;
+        }
+        else 
+        {
+            resultset->endOfRows = false;
+        }
+        CHECK_ODBC_ERROR( ret, statement );
+
+        resultset->blockRow = 0;
+
+        return true;
+    }
+
+    // convert the value of a column in the current row of the block from its bound array
+    void OdbcConnection::ReadBoundColumn( int column, ResultSet::RowBatch& target )
+    {
+        const ResultSet::ColumnDefinition& definition = resultset->GetMetadata( column );
+        const ResultSet::BoundColumn& bound = resultset->GetBoundColumn( column );
+        SQLULEN row = resultset->BlockRow();
+        SQLLEN indicator = bound.indicators[ row ];
+        const char* value = bound.Value( row );
+
+        if( indicator == SQL_NULL_DATA ) {
+
+            target.AppendNull();
+            return;
+        }
+
+        switch( bound.cType ) {
+        case SQL_C_SLONG:
             {
-                long val;
-                SQLRETURN ret = SQLGetData(statement, column + 1, SQL_C_SLONG, &val, sizeof(val), &strLen_or_IndPtr);
-                CHECK_ODBC_ERROR( ret, statement );
-                if (strLen_or_IndPtr == SQL_NULL_DATA) 
-                {
-                    resultset->SetColumn(make_shared<NullColumn>());
+                long val = *reinterpret_cast<const long*>( value );
+                if( definition.dataType == SQL_BIT ) {
+                    target.AppendBool( val != 0 );
                 }
-                else 
-                {
-                    resultset->SetColumn(make_shared<IntColumn>(val));
+                else {
+                    target.AppendInt( val );
                 }
             }
             break;
+        case SQL_C_DOUBLE:
+            target.AppendNumber( *reinterpret_cast<const double*>( value ));
+            break;
+        case SQL_C_NUMERIC:
+            {
+                char text[ NUMERIC_TEXT_MAX_LENGTH ];
+                size_t length = FormatNumeric( *reinterpret_cast<const SQL_NUMERIC_STRUCT*>( value ), text );
+                target.AppendCopy( ResultSet::Cell::AnsiString, text, length, false );
+            }
+            break;
+        case SQL_C_SBIGINT:
+            if( bigintAsString ) {
+                target.AppendInt64( *reinterpret_cast<const int64_t*>( value ));
+            }
+            else {
+                target.AppendInt64AsNumber( *reinterpret_cast<const int64_t*>( value ));
+            }
+            break;
+        case SQL_C_SS_TIMESTAMPOFFSET:
+            target.AppendDate( *reinterpret_cast<const SQL_SS_TIMESTAMPOFFSET_STRUCT*>( value ), dateCell );
+            break;
+        case SQL_C_SS_TIME2:
+            target.AppendDate( TimeToTimestamp( *reinterpret_cast<const SQL_SS_TIME2_STRUCT*>( value )), dateCell );
+            break;
+        case SQL_C_WCHAR:
+            target.AppendCopy( ResultSet::Cell::String, value, indicator, false );
+            break;
+        case SQL_C_CHAR:
+            target.AppendCopy( ResultSet::Cell::AnsiString, value, indicator, false );
+            break;
+        default:
+            assert( false );
+            break;
+        }
+    }
+
+    bool OdbcConnection::TryReadColumn(int column)
+    {
+        resultset->current.Clear();
+        resultset->current.StartRow();
+
+        return TryReadColumn( column, resultset->current );
+    }
+
+    // append the value of the column in the current row to the target batch
+    bool OdbcConnection::TryReadColumn( int column, ResultSet::RowBatch& target )
+    {
+        assert( column >= 0 && column < resultset->GetColumns() );
+
+        if( resultset->IsBlockCursor() ) {
+            ReadBoundColumn( column, target );
+            return true;
+        }
+
+        ColumnReader reader = columnReaders[ column ];
+        if( reader == nullptr ) {
+            return false;
+        }
+
+        return ( this->*reader )( column, target );
+    }
+
+    // the function that reads each type of column, chosen for every column once per result set so 
+    // reading a column doesn't switch on its type for every row
+    OdbcConnection::ColumnReader OdbcConnection::ReaderForType( SQLSMALLINT dataType ) const
+    {
+        switch( dataType ) {
+        case SQL_CHAR:
+        case SQL_VARCHAR:
+        case SQL_LONGVARCHAR:
+        case SQL_WCHAR:
+        case SQL_WVARCHAR:
+        case SQL_WLONGVARCHAR:
+        case SQL_SS_XML:
+        case SQL_GUID:
+            return &OdbcConnection::TryReadStringColumn;
+        case SQL_BIT:
+            return &OdbcConnection::TryReadBitColumn;
+        case SQL_SMALLINT:
+        case SQL_TINYINT:
+        case SQL_INTEGER:
+            return &OdbcConnection::TryReadFixedColumn<int32_t, SQL_C_SLONG, &ResultSet::RowBatch::AppendInt>;
         case SQL_DECIMAL:
         case SQL_NUMERIC:
+            if( decimalAsString ) {
+                return &OdbcConnection::TryReadNumericColumn;
+            }
+            return &OdbcConnection::TryReadFixedColumn<double, SQL_C_DOUBLE, &ResultSet::RowBatch::AppendNumber>;
         case SQL_REAL:
         case SQL_FLOAT:
         case SQL_DOUBLE:
+            return &OdbcConnection::TryReadFixedColumn<double, SQL_C_DOUBLE, &ResultSet::RowBatch::AppendNumber>;
+        // read as a 64 bit integer rather than having the driver convert it
         case SQL_BIGINT:
-            {
-                double val;
-                SQLRETURN ret = SQLGetData(statement, column + 1, SQL_C_DOUBLE, &val, sizeof(val), &strLen_or_IndPtr);
-                CHECK_ODBC_ERROR( ret, statement );
-                if (strLen_or_IndPtr == SQL_NULL_DATA) 
-                {
-                    resultset->SetColumn(make_shared<NullColumn>());
-                }
-                else 
-                {
-                    resultset->SetColumn(make_shared<NumberColumn>(val));
-                }
+            if( bigintAsString ) {
+                return &OdbcConnection::TryReadFixedColumn<int64_t, SQL_C_SBIGINT, &ResultSet::RowBatch::AppendInt64>;
             }
-            break;
+            return &OdbcConnection::TryReadFixedColumn<int64_t, SQL_C_SBIGINT, &ResultSet::RowBatch::AppendInt64AsNumber>;
         case SQL_BINARY:
         case SQL_VARBINARY:
         case SQL_LONGVARBINARY:
         case SQL_SS_UDT:
-
-            {
-                bool more = false;
-                vector<char> buffer(2048);
-                SQLRETURN ret = SQLGetData(statement, column + 1, SQL_C_BINARY, buffer.data(), buffer.size(), &strLen_or_IndPtr);
-                CHECK_ODBC_ERROR( ret, statement );
-                if (strLen_or_IndPtr == SQL_NULL_DATA) 
-                {
-                    resultset->SetColumn(make_shared<NullColumn>());
-                }
-                else 
-                {
-                    assert(strLen_or_IndPtr != SQL_NO_TOTAL); // per http://msdn.microsoft.com/en-us/library/windows/desktop/ms715441(v=vs.85).aspx
-
-                    SQLWCHAR SQLState[6];
-                    SQLINTEGER nativeError;
-                    SQLSMALLINT textLength;
-                    if (ret == SQL_SUCCESS_WITH_INFO)
-                    {
-                        ret = SQLGetDiagRec(SQL_HANDLE_STMT, statement, 1, SQLState, &nativeError, NULL, 0, &textLength);
-                        CHECK_ODBC_ERROR( ret, statement );
-                        more = wcsncmp(SQLState, L"01004", 6) == 0;
-                    }
-
-					int amount = strLen_or_IndPtr;
-					if (more) {
-						amount = buffer.size();
-					}
-
-                    vector<char> trimmed(amount);
-                    memcpy(trimmed.data(), buffer.data(), amount);
-                    resultset->SetColumn(make_shared<BinaryColumn>(trimmed, more));
-                }
-            }
-            break;
+            return &OdbcConnection::TryReadBinaryColumn;
         // use text format form time/date/etc.. for now
         // INTERVAL TYPES? 
         case SQL_TYPE_TIMESTAMP:
         case SQL_TYPE_DATE:
         case SQL_SS_TIMESTAMPOFFSET:
+            return &OdbcConnection::TryReadTimestampColumn;
+        case SQL_TYPE_TIME:
+        case SQL_SS_TIME2:
+            return &OdbcConnection::TryReadTimeColumn;
+        default:
+            // this shouldn't ever be hit.  Every T-SQL type should be covered above.
+            assert( false );
+            return nullptr;
+        }
+    }
+
+    bool OdbcConnection::TryReadStringColumn( int column, ResultSet::RowBatch& target )
+    {
+        return TryReadString( false, column, target );
+    }
+
+    // columns read with a single SQLGetData of a fixed size C type and appended to the batch as that value
+    template<typename Value, SQLSMALLINT CType, void (ResultSet::RowBatch::*Append)( Value )>
+    bool OdbcConnection::TryReadFixedColumn( int column, ResultSet::RowBatch& target )
+    {
+        Value val;
+        SQLLEN strLen_or_IndPtr;
+        SQLRETURN ret = SQLGetData(statement, column + 1, CType, &val, sizeof(val), &strLen_or_IndPtr);
+        CHECK_ODBC_ERROR( ret, statement );
+        if (strLen_or_IndPtr == SQL_NULL_DATA) 
+        {
+            target.AppendNull();
+        }
+        else 
+        {
+            ( target.*Append )( val );
+        }
+
+        return true;
+    }
+
+    // exact decimal values are formatted as text here, on the background thread, with the precision and 
+    // scale set by TryPrepareNumericColumns
+    bool OdbcConnection::TryReadNumericColumn( int column, ResultSet::RowBatch& target )
+    {
+        SQL_NUMERIC_STRUCT numeric;
+        SQLLEN strLen_or_IndPtr;
+        SQLRETURN ret = SQLGetData( statement, column + 1, SQL_ARD_TYPE, &numeric, sizeof( numeric ), &strLen_or_IndPtr );
+        CHECK_ODBC_ERROR( ret, statement );
+        if( strLen_or_IndPtr == SQL_NULL_DATA ) {
+
+            target.AppendNull();
+            return true;
+        }
+
+        char text[ NUMERIC_TEXT_MAX_LENGTH ];
+        size_t length = FormatNumeric( numeric, text );
+        target.AppendCopy( ResultSet::Cell::AnsiString, text, length, false );
+
+        return true;
+    }
+
+    bool OdbcConnection::TryReadBitColumn( int column, ResultSet::RowBatch& target )
+    {
+        long val;
+        SQLLEN strLen_or_IndPtr;
+        SQLRETURN ret = SQLGetData(statement, column + 1, SQL_C_SLONG, &val, sizeof(val), &strLen_or_IndPtr);
+        CHECK_ODBC_ERROR( ret, statement );
+        if (strLen_or_IndPtr == SQL_NULL_DATA) 
+        {
+            target.AppendNull();
+        }
+        else 
+        {
+            target.AppendBool( val != 0 );
+        }
+
+        return true;
+    }
+
+    // Binary values are read once into memory of their exact size, which becomes the memory of the Buffer
+    // returned.  The length is retrieved first with an empty read.  If the driver can't say how much is 
+    // left, the memory is doubled with each read until the whole value is in it.  With a LOB chunk size 
+    // in the query options, values longer than it are returned a chunk at a time instead.
+    bool OdbcConnection::TryReadBinaryColumn( int column, ResultSet::RowBatch& target )
+    {
+        SQLLEN strLen_or_IndPtr;
+        char empty;
+        SQLRETURN ret = SQLGetData(statement, column + 1, SQL_C_BINARY, &empty, 0, &strLen_or_IndPtr);
+        CHECK_ODBC_ERROR( ret, statement );
+        if (strLen_or_IndPtr == SQL_NULL_DATA) 
+        {
+            target.AppendNull();
+            return true;
+        }
+
+        SQLLEN chunk = strLen_or_IndPtr;
+        if (lobChunkSize > 0 && (strLen_or_IndPtr == SQL_NO_TOTAL || strLen_or_IndPtr > lobChunkSize)) 
+        {
+            chunk = lobChunkSize;
+        }
+        else if (strLen_or_IndPtr == SQL_NO_TOTAL) 
+        {
+            chunk = LOB_PACKET_SIZE;
+        }
+        if (chunk > BINARY_MAX_SIZE) 
+        {
+            chunk = BINARY_MAX_SIZE;
+        }
+
+        shared_ptr<ResultSet::BinaryValue> value = make_shared<ResultSet::BinaryValue>( chunk );
+        SQLLEN read = 0;
+        bool more = false;
+
+        while (chunk > 0) 
+        {
+            ret = SQLGetData(statement, column + 1, SQL_C_BINARY, value->Data() + read, chunk, &strLen_or_IndPtr);
+            CHECK_ODBC_ERROR( ret, statement );
+
+            // what was left fit
+            if (strLen_or_IndPtr != SQL_NO_TOTAL && strLen_or_IndPtr <= chunk) 
             {
-                SQL_SS_TIMESTAMPOFFSET_STRUCT datetime;
-                memset( &datetime, 0, sizeof( datetime ));
+                read += strLen_or_IndPtr;
+                break;
+            }
 
-                SQLRETURN ret = SQLGetData( statement, column + 1, SQL_C_DEFAULT, &datetime, sizeof( datetime ),
-                                            &strLen_or_IndPtr );
-                CHECK_ODBC_ERROR( ret, statement );
-                if (strLen_or_IndPtr == SQL_NULL_DATA) 
-                {
-                    resultset->SetColumn(make_shared<NullColumn>());
-                    break;
-                }
+            read += chunk;
 
-                resultset->SetColumn( make_shared<TimestampColumn>( datetime ));
+            if (lobChunkSize > 0 || read >= BINARY_MAX_SIZE) 
+            {
+                more = true;
+                break;
             }
-            break;
-        case SQL_TYPE_TIME:
-        case SQL_SS_TIME2:
+
+            // grow to exactly what is left, or double when the driver doesn't know
+            chunk = (strLen_or_IndPtr == SQL_NO_TOTAL) ? read : strLen_or_IndPtr - chunk;
+            if (chunk > BINARY_MAX_SIZE - read) 
             {
-                SQL_SS_TIME2_STRUCT time;
-                memset( &time, 0, sizeof( time ));
+                chunk = BINARY_MAX_SIZE - read;
+            }
 
-                SQLRETURN ret = SQLGetData( statement, column + 1, SQL_C_DEFAULT, &time, sizeof( time ),
-                                            &strLen_or_IndPtr );
-                CHECK_ODBC_ERROR( ret, statement );
-                if (strLen_or_IndPtr == SQL_NULL_DATA) 
-                {
-                    resultset->SetColumn(make_shared<NullColumn>());
-                    break;
-                }
+            value->Resize( read, read + chunk );
+        }
+
+        target.AppendOwned( ResultSet::Cell::Binary, value, read, more );
 
-                SQL_SS_TIMESTAMPOFFSET_STRUCT datetime;
-                memset( &datetime, 0, sizeof( datetime ));  // not necessary, but simple precaution
-                datetime.year = SQL_SERVER_DEFAULT_YEAR;
-                datetime.month = SQL_SERVER_DEFAULT_MONTH;
-                datetime.day = SQL_SERVER_DEFAULT_DAY;
-                datetime.hour = time.hour;
-                datetime.minute = time.minute;
-                datetime.second = time.second;
-                datetime.fraction = time.fraction;
+        return true;
+    }
+
+    // Values of the LOB sink column are written to the sink file a buffer at a time as they are read on
+    // this thread, and only the number of bytes written is returned.  Strings are written as UTF-16.
+    bool OdbcConnection::TryReadSinkColumn( int column, ResultSet::RowBatch& target )
+    {
+        bool binary = !IsStringType( resultset->GetMetadata( column ).dataType );
+        SQLSMALLINT cType = binary ? SQL_C_BINARY : SQL_C_WCHAR;
+        SQLLEN size = static_cast<SQLLEN>( lobSinkBuffer.size() );
+        SQLLEN capacity = binary ? size : size - sizeof( uint16_t );     // less the null terminator
+        SQLLEN written = 0;
 
-                resultset->SetColumn( make_shared<TimestampColumn>( datetime ));
+        while( true ) {
+
+            SQLLEN strLen_or_IndPtr;
+            SQLRETURN ret = SQLGetData( statement, column + 1, cType, lobSinkBuffer.data(), size, &strLen_or_IndPtr );
+            CHECK_ODBC_ERROR( ret, statement );
+            if( strLen_or_IndPtr == SQL_NULL_DATA ) {
+
+                target.AppendNull();
+                return true;
             }
-            break;
-        default:
-            // this shouldn't ever be hit.  Every T-SQL type should be covered above.
-            assert( false );
+
+            // the rest of the value fit when there's no truncation warning
+            bool complete = ( ret == SQL_SUCCESS );
+            SQLLEN amount = complete ? strLen_or_IndPtr : capacity;
+
+            DWORD done = 0;
+            if( amount > 0 && ( !WriteFile( lobSink, lobSinkBuffer.data(), static_cast<DWORD>( amount ), &done, NULL ) || 
+                                static_cast<SQLLEN>( done ) != amount )) {
+                error = make_shared<OdbcError>( OdbcError::NODE_LOB_SINK_WRITE );
+                return false;
+            }
+            written += amount;
+
+            if( complete ) {
+                break;
+            }
+        }
+
+        target.AppendNumber( static_cast<double>( written ));
+
+        return true;
+    }
+
+    void OdbcConnection::CloseLobSink()
+    {
+        if( lobSink != INVALID_HANDLE_VALUE ) {
+            CloseHandle( lobSink );
+            lobSink = INVALID_HANDLE_VALUE;
+        }
+        lobSinkColumn = -1;
+    }
+
+    bool OdbcConnection::TryReadTimestampColumn( int column, ResultSet::RowBatch& target )
+    {
+        SQLLEN strLen_or_IndPtr;
+        SQL_SS_TIMESTAMPOFFSET_STRUCT datetime;
+        memset( &datetime, 0, sizeof( datetime ));
+
+        SQLRETURN ret = SQLGetData( statement, column + 1, SQL_C_DEFAULT, &datetime, sizeof( datetime ),
+                                    &strLen_or_IndPtr );
+        CHECK_ODBC_ERROR( ret, statement );
+        if (strLen_or_IndPtr == SQL_NULL_DATA) 
+        {
+            target.AppendNull();
+            return true;
+        }
+
+        target.AppendDate( datetime, dateCell );
+
+        return true;
+    }
+
+    bool OdbcConnection::TryReadTimeColumn( int column, ResultSet::RowBatch& target )
+    {
+        SQLLEN strLen_or_IndPtr;
+        SQL_SS_TIME2_STRUCT time;
+        memset( &time, 0, sizeof( time ));
+
+        SQLRETURN ret = SQLGetData( statement, column + 1, SQL_C_DEFAULT, &time, sizeof( time ),
+                                    &strLen_or_IndPtr );
+        CHECK_ODBC_ERROR( ret, statement );
+        if (strLen_or_IndPtr == SQL_NULL_DATA) 
+        {
+            target.AppendNull();
+            return true;
+        }
+
+        target.AppendDate( TimeToTimestamp( time ), dateCell );
+
+        return true;
+    }
+
+    // read the next row and all of its columns in one pass.  The row comes from the rows of the batch not yet 
+    // returned, then from the rows read ahead, and only then from the cursor.
+    bool OdbcConnection::TryReadRowValues()
+    {
+        if( resultset->BatchRowsLeft() ) {
+            resultset->ReturnBatchRows( 1 );
+            return true;
+        }
+
+        if( !TryNextBatch( 1 )) {
             return false;
         }
+        resultset->ReturnBatchRows( 1 );
 
         return true;
     }
 
-    bool OdbcConnection::TryReadString( bool binary, int column )
+    // return the rest of the batch or up to count rows read into it
+    bool OdbcConnection::TryReadRows( int count )
     {
-        SQLLEN display_size = 0;
-        unique_ptr<StringColumn::StringValue> value( new StringColumn::StringValue() );
-        SQLLEN value_len = 0;
-        SQLRETURN r = SQL_SUCCESS;
+        if( resultset->BatchRowsLeft() ) {
+            resultset->ReturnBatchRows( resultset->batch.Rows() );
+            return true;
+        }
 
-        r = SQLColAttribute( statement, column + 1, SQL_DESC_DISPLAY_SIZE, NULL, 0, NULL, &display_size );
-        CHECK_ODBC_ERROR( r, statement );
+        if( !TryNextBatch( count )) {
+            return false;
+        }
+        resultset->ReturnBatchRows( resultset->batch.Rows() );
+
+        return true;
+    }
+
+    // read up to count rows into the result set's batch, using the rows read ahead if there are any
+    bool OdbcConnection::TryNextBatch( int count )
+    {
+        resultset->batchFirst = 0;
+        resultset->batchEnd = 0;
+
+        if( resultset->prefetched.empty() ) {
+            return TryFetchRows( resultset->batch, count );
+        }
+
+        resultset->batch.swap( resultset->prefetched.front() );
+        resultset->prefetched.pop_front();
+
+        if( resultset->batch.error ) {
+            error = resultset->batch.error;
+            return false;
+        }
+
+        return true;
+    }
+
+    // Read ahead into the result set's prefetch buffers while the last batch is processed in Javascript.
+    // This is queued after a batch is returned, so the result set may have moved on since.
+    bool OdbcConnection::TryPrefetchRows( shared_ptr<ResultSet> target, int count )
+    {
+        if( target != resultset ) {
+            return true;
+        }
+
+        while( static_cast<int>( resultset->prefetched.size() ) < prefetchDepth ) {
+
+            // stop at the end of the rows or in the middle of a row that ReadColumn will finish
+            const ResultSet::RowBatch& last = resultset->prefetched.empty() ? resultset->batch : resultset->prefetched.back();
+            if( last.endOfRows || last.More() ) {
+                break;
+            }
+
+            resultset->prefetched.push_back( ResultSet::RowBatch() );
+            ResultSet::RowBatch& batch = resultset->prefetched.back();
 
-        // when a field type is LOB, we read a packet at time and pass that back.
-        if( display_size == 0 || display_size == std::numeric_limits<int>::max() || 
-            display_size == std::numeric_limits<int>::max() >> 1 || 
-            display_size == std::numeric_limits<unsigned long>::max() - 1 ) {
+            // the error is returned by the ReadRows that reaches this batch
+            if( !TryFetchRows( batch, count )) {
+                batch.error = error;
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    // read up to count rows and all their columns into a batch.  Reading stops early at a column that
+    // has more data to retrieve (a LOB) so the remainder of that column can be read by ReadColumn.  
+    // The row containing that column is the last row in the batch.
+    bool OdbcConnection::TryFetchRows( ResultSet::RowBatch& batch, int count )
+    {
+        batch.Clear();
+
+        for( int r = 0; r < count; ++r ) {
+
+            bool read = TryReadRow();
+            if( !read ) {
+                return false;
+            }
+            if( resultset->EndOfRows() ) {
+                batch.endOfRows = true;
+                break;
+            }
+
+            batch.StartRow();
+
+            for( int c = 0; c < resultset->GetColumns(); ++c ) {
+
+                read = TryReadColumn( c, batch );
+                if( !read ) {
+                    return false;
+                }
+
+                if( batch.More() ) {
+                    return true;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // read all the remaining rows of the result set into one array per column.  Rows already read
+    // ahead are taken first, and if they end in the middle of a row that row is finished from the cursor.
+    bool OdbcConnection::TryReadColumnar()
+    {
+        vector<ColumnarColumn>& columnar = resultset->columnar;
+
+        columnar.clear();
+        for( int c = 0; c < resultset->GetColumns(); ++c ) {
+            // the LOB sink column holds the number of bytes written
+            SQLSMALLINT dataType = resultset->GetMetadata( c ).dataType;
+            ColumnarColumn::Kind kind = ColumnarColumn::KindFromType( dataType );
+            if( columnReaders[ c ] == &OdbcConnection::TryReadSinkColumn ) {
+                kind = ColumnarColumn::Number;
+            }
+            else if( dataType == SQL_BIGINT && bigintAsString ) {
+                kind = ColumnarColumn::Int64;
+            }
+            else if( IsNumericType( dataType ) && decimalAsString ) {
+                kind = ColumnarColumn::Text;
+            }
+            columnar.push_back( ColumnarColumn( kind ));
+        }
+
+        bool endOfRows = false;
+
+        while( !resultset->prefetched.empty() ) {
+
+            ResultSet::RowBatch batch;
+            batch.swap( resultset->prefetched.front() );
+            resultset->prefetched.pop_front();
+
+            if( batch.error ) {
+                error = batch.error;
+                return false;
+            }
+
+            for( size_t r = 0; r < batch.Rows(); ++r ) {
+                for( size_t c = 0; c < batch.RowColumns( r ); ++c ) {
+                    batch.AppendCellTo( batch.GetCell( r, c ), columnar[c] );
+                }
+            }
+
+            // the column read last continues from the cursor along with the rest of its row
+            if( batch.More() ) {
+                bool read = TryReadColumnarColumns( batch.RowColumns( batch.Rows() - 1 ) - 1 );
+                if( !read ) {
+                    return false;
+                }
+            }
+
+            endOfRows = batch.endOfRows;
+        }
+
+        while( !endOfRows ) {
+
+            bool read = TryReadRow();
+            if( !read ) {
+                return false;
+            }
+            if( resultset->EndOfRows() ) {
+                break;
+            }
+
+            read = TryReadColumnarColumns( 0 );
+            if( !read ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // read the columns of the current row from first on into the columnar result, all the pieces of
+    // a LOB appended to the same value
+    bool OdbcConnection::TryReadColumnarColumns( int first )
+    {
+        ResultSet::RowBatch& cell = resultset->current;
+
+        for( int c = first; c < resultset->GetColumns(); ++c ) {
+
+            do {
+                cell.Clear();
+                cell.StartRow();
+
+                bool read = TryReadColumn( c, cell );
+                if( !read ) {
+                    return false;
+                }
+
+                cell.AppendCellTo( cell.cells.back(), resultset->columnar[c] );
+
+            } while( cell.More() );
+        }
+
+        return true;
+    }
+
+    // strings are read directly into the arena of the target batch
+    bool OdbcConnection::TryReadString( bool binary, int column, ResultSet::RowBatch& target )
+    {
+        const ResultSet::ColumnDefinition& definition = resultset->GetMetadata( column );
+        SQLLEN display_size = definition.displaySize;
+        SQLLEN value_len = 0;
+
+        // when a field type is LOB, the whole value is read here into one string, in reads that grow to what 
+        // the driver says is left or double when it can't say.  With a LOB chunk size in the query options, 
+        // a chunk is read at a time instead and passed back with more set.
+        if( definition.lob ) {
 
             bool more = false;
+            SQLLEN chunk = ( lobChunkSize > 0 ) ? lobChunkSize : LOB_PACKET_SIZE;     // characters
+            SQLLEN read = 0;                                                            // bytes
+            shared_ptr<ResultSet::BinaryValue> owned;       // once long enough to be an external string
 
-            value_len = LOB_PACKET_SIZE + 1;
+            while( true ) {
 
-            value->resize( value_len );
+                SQLLEN request = ( chunk + 1 ) * sizeof( uint16_t );
 
-            SQLRETURN r = SQLGetData( statement, column + 1, SQL_C_WCHAR, value->data(), value_len * 
-                sizeof( StringColumn::StringValue::value_type ), &value_len );
+                // reserving again keeps what has been read so far
+                char* value = owned ? owned->Data() : target.ReserveBytes( read + request );
 
-            CHECK_ODBC_NO_DATA( r, statement );
-            CHECK_ODBC_ERROR( r, statement );
+                SQLRETURN r = SQLGetData( statement, column + 1, SQL_C_WCHAR, value + read, request, &value_len );
 
-            if( value_len == SQL_NULL_DATA ) {
+                CHECK_ODBC_NO_DATA( r, statement );
+                CHECK_ODBC_ERROR( r, statement );
 
-                resultset->SetColumn( make_shared<NullColumn>());
-                return true;          
+                if( value_len == SQL_NULL_DATA ) {
+
+                    target.AppendNull();
+                    return true;          
+                }
+
+                // what was left fit, less the null terminator
+                if( value_len != SQL_NO_TOTAL && value_len / sizeof( uint16_t ) <= static_cast<SQLULEN>( chunk )) {
+
+                    read += value_len;
+                    break;
+                }
+
+                read += chunk * sizeof( uint16_t );
+
+                SQLLEN length = read / sizeof( uint16_t );
+                if( lobChunkSize > 0 || length >= STRING_MAX_LENGTH ) {
+
+                    more = true;
+                    break;
+                }
+
+                // an unknown amount is left on the field so no total was returned
+                chunk = ( value_len == SQL_NO_TOTAL ) ? length : static_cast<SQLLEN>( value_len / sizeof( uint16_t )) - chunk;
+                if( chunk > STRING_MAX_LENGTH - length ) {
+
+                    chunk = STRING_MAX_LENGTH - length;
+                }
+
+                // a value long enough to be an external string goes on in memory of its own, which the string takes
+                if( owned ) {
+
+                    owned->Resize( read, read + ( chunk + 1 ) * sizeof( uint16_t ));
+                }
+                else if( static_cast<size_t>( length ) >= ResultSet::EXTERNAL_STRING_MIN_LENGTH ) {
+
+                    owned = make_shared<ResultSet::BinaryValue>( read + ( chunk + 1 ) * sizeof( uint16_t ));
+                    memcpy( owned->Data(), target.ReserveBytes( read ), read );
+                }
             }
 
-            // an unknown amount is left on the field so no total was returned
-            if( value_len == SQL_NO_TOTAL || value_len / sizeof( StringColumn::StringValue::value_type ) > LOB_PACKET_SIZE ) {
+            // read is in bytes
+            if( owned ) {
 
-                more = true;
-                value->resize( LOB_PACKET_SIZE );
+                target.AppendOwned( ResultSet::Cell::ExternalString, owned, read, more );
             }
             else {
 
-                // value_len is in bytes
-                value->resize( value_len / sizeof( StringColumn::StringValue::value_type ));
-                more = false;
+                target.AppendBytes( ResultSet::Cell::String, read, more );
+            }
+
+            return true;
+        }
+        // varchar may be read in the client code page, half the size of UTF-16 for the usual (ASCII) text
+        else if( narrowVarchar && IsVarcharType( definition.dataType ) && 
+                 display_size >= 1 && display_size <= SQL_SERVER_MAX_STRING_SIZE ) {
+
+            // converting to the client code page may take two bytes for a character, plus the null terminator
+            SQLLEN buffer_size = display_size * 2 + 1;
+
+            char* value = target.ReserveBytes( buffer_size );
+
+            SQLRETURN r = SQLGetData( statement, column + 1, SQL_C_CHAR, value, buffer_size, &value_len );
+            CHECK_ODBC_NO_DATA( r, statement );
+            CHECK_ODBC_ERROR( r, statement );
+
+            if( value_len == SQL_NULL_DATA ) {
+
+                target.AppendNull();
+                return true;          
             }
 
-            resultset->SetColumn( make_shared<StringColumn>( value, more ));
+            assert( value_len >= 0 && value_len < buffer_size );
+
+            target.AppendBytes( ResultSet::Cell::AnsiString, value_len, false );
 
             return true;
         }
         else if( display_size >= 1 && display_size <= SQL_SERVER_MAX_STRING_SIZE ) {
 
             display_size++;                 // increment for null terminator
-            value->resize( display_size );
 
-            SQLRETURN r = SQLGetData( statement, column + 1, SQL_C_WCHAR, value->data(), display_size * 
-                                      sizeof( StringColumn::StringValue::value_type ), &value_len );
-            CHECK_ODBC_ERROR( r, statement );
+            char* value = target.ReserveBytes( display_size * sizeof( uint16_t ));
+
+            SQLRETURN r = SQLGetData( statement, column + 1, SQL_C_WCHAR, value, display_size * sizeof( uint16_t ), 
+                                      &value_len );
             CHECK_ODBC_NO_DATA( r, statement );
+            CHECK_ODBC_ERROR( r, statement );
 
             if( value_len == SQL_NULL_DATA ) {
 
-                resultset->SetColumn(make_shared<NullColumn>());
+                target.AppendNull();
                 return true;          
             }
 
             assert( value_len % 2 == 0 );   // should always be even
-            value_len /= sizeof( StringColumn::StringValue::value_type );
-
-            assert( value_len >= 0 && value_len <= display_size - 1 );
-            value->resize( value_len );
+            assert( value_len >= 0 && value_len / sizeof( uint16_t ) <= display_size - 1 );
 
-            resultset->SetColumn( make_shared<StringColumn>( value, false ));
+            target.AppendBytes( ResultSet::Cell::String, value_len, false );
 
             return true;
         }
@@ -489,11 +1794,13 @@ namespace mssql
         { 
             endOfResults = true;
             statement.Free();
+            CloseLobSink();
             return true;
         }
         CHECK_ODBC_ERROR( ret, statement );
 
         endOfResults = false;
+        ++resultOrdinal;
 
         return StartReadingResults();
     }
@@ -37,6 +37,10 @@ namespace mssql
         OdbcStatementHandle statement;
         CriticalSection closeCriticalSection;
 
+        // held by each operation while it runs on the background thread, so operations queued for this 
+        // connection (including reading ahead) never use the statement at the same time
+        CriticalSection operationCriticalSection;
+
         // any error that occurs when a Try* function returns false is stored here
         // and may be retrieved via the Error function below.
         shared_ptr<OdbcError> error;
@@ -52,10 +56,88 @@ namespace mssql
         int column;
         bool endOfResults;
 
+        // number of batches of rows to read ahead for the current query
+        int prefetchDepth;
+
+        // size of the pieces large object values are returned in, or 0 to read each value whole
+        int lobChunkSize;
+
+        // read char and varchar columns as SQL_C_CHAR rather than UTF-16
+        bool narrowVarchar;
+
+        // return bigint columns exactly as strings (or pairs of 32 bit halves in columns) rather than numbers
+        bool bigintAsString;
+
+        // return decimal and numeric columns exactly as strings rather than numbers
+        bool decimalAsString;
+        bool TryPrepareNumericColumns();
+
+        // the type of cell dates are returned as, chosen by the dates query option
+        ResultSet::Cell::Type dateCell;
+
+        // column whose values are written to the lobSink file rather than returned, or -1 for none
+        int lobSinkColumn;
+        HANDLE lobSink;
+        vector<char> lobSinkBuffer;
+
+        void CloseLobSink();
+
+        // the connection was opened with bulk copy enabled, which bulkLoad needs
+        bool bulkCopy;
+
+        // a bulk copy started by TryBulkInit is in progress on the connection
+        bool bulkLoading;
+
+        // column definitions of the result sets of queries already run on this connection, keyed by the 
+        // query text and which of its result sets it is.  Running the same query again checks the column 
+        // count and types rather than describing every column.
+        typedef map<pair<wstring, int>, vector<ResultSet::ColumnDefinition>> MetadataCache;
+        MetadataCache metadataCache;
+        wstring currentQuery;
+        int resultOrdinal;
+
+        bool TryDescribeColumns();
+        bool TryReuseMetadata( bool& reused );
+
         bool BindParams( QueryOperation::param_bindings& params );
 
+        // the distinct declared parameter types each query has been run with, each of which the server compiles
+        // its own plan for.  Read from the node.js thread, so guarded by its own lock.
+        map<wstring, set<wstring>> paramSignatures;
+        mutable CriticalSection paramSignaturesCriticalSection;
+
+        void CountParamSignature( const wstring& query, const QueryOperation::param_bindings& params );
+        bool TryBindTableParam( SQLUSMALLINT param, QueryOperation::ParamBinding& binding );
+
         // set binary true if a binary Buffer should be returned instead of a JS string
-        bool TryReadString( bool binary, int column ); 
+        bool TryReadString( bool binary, int column, ResultSet::RowBatch& target ); 
+
+        // appends the current column of the current row to a batch
+        typedef bool (OdbcConnection::*ColumnReader)( int column, ResultSet::RowBatch& target );
+
+        // reader of each column of the current result set
+        vector<ColumnReader> columnReaders;
+
+        ColumnReader ReaderForType( SQLSMALLINT dataType ) const;
+
+        bool TryReadColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadStringColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadBitColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadNumericColumn( int column, ResultSet::RowBatch& target );
+        template<typename Value, SQLSMALLINT CType, void (ResultSet::RowBatch::*Append)( Value )>
+        bool TryReadFixedColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadBinaryColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadTimestampColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadSinkColumn( int column, ResultSet::RowBatch& target );
+        bool TryReadTimeColumn( int column, ResultSet::RowBatch& target );
+
+        // bind the columns of the current result set to arrays when they are all fixed width
+        bool TryBindColumns();
+        void UnbindColumns();
+        void ReadBoundColumn( int column, ResultSet::RowBatch& target );
+
+        bool TryFetchRows( ResultSet::RowBatch& batch, int count );
+        bool TryReadColumnarColumns( int first );
 
     public:
         shared_ptr<ResultSet> resultset;
@@ -64,21 +146,60 @@ namespace mssql
             : connectionState(Closed),
               error(NULL),
               column(0),
-              endOfResults(true)
+              endOfResults(true),
+              prefetchDepth(0),
+              lobChunkSize(0),
+              narrowVarchar(false),
+              bigintAsString(false),
+              decimalAsString(false),
+              dateCell(ResultSet::Cell::Date),
+              lobSinkColumn(-1),
+              lobSink(INVALID_HANDLE_VALUE),
+              bulkCopy(false),
+              bulkLoading(false),
+              resultOrdinal(0)
+        {
+        }
+
+        ~OdbcConnection()
         {
+            CloseLobSink();
+        }
+
+        CriticalSection& OperationCriticalSection()
+        {
+            return operationCriticalSection;
+        }
+
+        int PrefetchDepth() const
+        {
+            return prefetchDepth;
         }
 
         static bool InitializeEnvironment();
 
+        // distinct parameter signatures query has been run with, or those of every query when it is empty
+        int ParamSignatureCount( const wstring& query ) const;
+
         bool StartReadingResults();
 
         bool TryBeginTran();
         bool TryClose();
-        bool TryOpen(const wstring& connectionString);
-        bool TryExecute( const wstring& query, QueryOperation::param_bindings& paramIt );
+        bool TryOpen(const wstring& connectionString, bool bulkCopy);
+        bool TryExecute( const wstring& query, QueryOperation::param_bindings& paramIt, const QueryOptions& options );
+        bool TryExecuteBatch( const wstring& query, ParamArray::param_columns& columns, SQLULEN rows, 
+                              SQLUSMALLINT* status, SQLLEN& rowcount );
+        bool TryBulkInit( const wstring& table, const wstring& hints );
+        bool TryBulkSend( ParamArray::param_columns& columns, SQLULEN rows, const vector<int>& ordinals, DBINT& sent );
+        bool TryBulkDone( DBINT& rowcount );
         bool TryEndTran(SQLSMALLINT completionType);
         bool TryReadRow();
         bool TryReadColumn(int column);
+        bool TryReadRowValues();
+        bool TryReadRows(int count);
+        bool TryNextBatch(int count);
+        bool TryPrefetchRows(shared_ptr<ResultSet> target, int count);
+        bool TryReadColumnar();
         bool TryReadNextResult();
 
         Handle<Value> GetMetaValue()
@@ -103,9 +224,47 @@ namespace mssql
         {
             HandleScope scope;
             Local<Object> result = Object::New();
-            shared_ptr<Column> column = resultset->GetColumn();
-            result->Set(New(L"data"), column->ToValue());
-            result->Set(New(L"more"), Boolean::New(column->More()));
+            result->Set(New(L"data"), resultset->CurrentToValue());
+            result->Set(New(L"more"), Boolean::New(resultset->CurrentMore()));
+            return scope.Close(result);
+        }
+
+        Handle<Value> GetRowValues()
+        {
+            HandleScope scope;
+            Local<Object> result = Object::New();
+            bool endOfRows = resultset->BatchSize() == 0;
+            result->Set(New(L"endOfRows"), Boolean::New(endOfRows));
+            if (!endOfRows)
+            {
+                result->Set(New(L"data"), resultset->RowToValue(resultset->batchFirst));
+                result->Set(New(L"more"), Boolean::New(resultset->BatchMore()));
+            }
+            return scope.Close(result);
+        }
+
+        // rows are returned as arrays of column values, or as objects when objects is true
+        Handle<Value> GetRows( bool objects )
+        {
+            HandleScope scope;
+            Local<Object> result = Object::New();
+            result->Set(New(L"endOfRows"), Boolean::New(resultset->BatchEndOfRows()));
+            result->Set(New(L"rows"), objects ? resultset->BatchToObjects() : resultset->BatchToValue());
+            result->Set(New(L"more"), Boolean::New(resultset->BatchMore()));
+            if (resultset->BatchMore())
+            {
+                result->Set(New(L"column"), Integer::New(resultset->BatchMoreColumn()));
+            }
+            return scope.Close(result);
+        }
+
+        Handle<Value> GetColumnar()
+        {
+            HandleScope scope;
+            Local<Object> result = Object::New();
+            size_t rows = resultset->columnar.empty() ? 0 : resultset->columnar.front().Rows();
+            result->Set(New(L"rows"), Integer::NewFromUnsigned(rows));
+            result->Set(New(L"columns"), resultset->ColumnarToValue());
             return scope.Close(result);
         }
 
@@ -83,11 +83,11 @@ namespace mssql
             return scope.Close(Undefined());
         }
 
-        Handle<Value> Query(Handle<String> query, Handle<Array> params, Handle<Object> callback)
+        Handle<Value> Query(Handle<String> query, Handle<Array> params, Handle<Value> options, Handle<Object> callback)
         {
             HandleScope scope;
 
-            QueryOperation* operation = new QueryOperation(connection, FromV8String(query), callback);
+            QueryOperation* operation = new QueryOperation(connection, FromV8String(query), options, callback);
 
             bool bound = operation->BindParameters( params );
 
@@ -98,6 +98,66 @@ namespace mssql
 
             return scope.Close(Undefined());
         }
+
+        Handle<Value> ExecuteBatch(Handle<String> query, Handle<Array> rows, Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            ExecuteBatchOperation* operation = new ExecuteBatchOperation(connection, FromV8String(query), callback);
+
+            bool bound = operation->BindParameters( rows );
+
+            if( bound ) {
+
+                Operation::Add(operation);
+            }
+            else {
+
+                delete operation;
+            }
+
+            return scope.Close(Undefined());
+        }
+
+        Handle<Value> BulkInit(Handle<String> table, Handle<String> hints, Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            Operation* operation = new BulkInitOperation(connection, FromV8String(table), FromV8String(hints), callback);
+            Operation::Add(operation);
+
+            return scope.Close(Undefined());
+        }
+
+        Handle<Value> BulkSend(Handle<Array> rows, Handle<Array> ordinals, Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            BulkSendOperation* operation = new BulkSendOperation(connection, ordinals, callback);
+
+            bool bound = operation->BindParameters( rows );
+
+            if( bound ) {
+
+                Operation::Add(operation);
+            }
+            else {
+
+                delete operation;
+            }
+
+            return scope.Close(Undefined());
+        }
+
+        Handle<Value> BulkDone(Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            Operation* operation = new BulkDoneOperation(connection, callback);
+            Operation::Add(operation);
+
+            return scope.Close(Undefined());
+        }
         
         Handle<Value> ReadRow(Handle<Object> callback)
         {
@@ -109,6 +169,13 @@ namespace mssql
             return scope.Close(Undefined());
         }
         
+        Handle<Integer> ParamSignatures( Handle<String> query )
+        {
+            HandleScope scope;
+
+            return scope.Close( Integer::New( connection->ParamSignatureCount( FromV8String( query ))));
+        }
+
         Handle<Integer> ReadRowCount( void )
         {
             HandleScope scope;
@@ -139,11 +206,42 @@ namespace mssql
             return scope.Close(Undefined());
         }
 
-        Handle<Value> Open(Handle<String> connectionString, Handle<Object> callback, Handle<Object> backpointer)
+        Handle<Value> ReadRowValues(Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            Operation* operation = new ReadRowValuesOperation(connection, callback);
+            Operation::Add(operation);
+
+            return scope.Close(Undefined());
+        }
+
+        Handle<Value> ReadRows(Handle<Number> count, bool objects, Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            Operation* operation = new ReadRowsOperation(connection, count->Int32Value(), objects, callback);
+            Operation::Add(operation);
+
+            return scope.Close(Undefined());
+        }
+
+        Handle<Value> ReadColumnar(Handle<Object> callback)
+        {
+            HandleScope scope;
+
+            Operation* operation = new ReadColumnarOperation(connection, callback);
+            Operation::Add(operation);
+
+            return scope.Close(Undefined());
+        }
+
+        Handle<Value> Open(Handle<String> connectionString, bool bulkCopy, Handle<Object> callback, Handle<Object> backpointer)
         {
             HandleScope scope;
 
-            Operation* operation = new OpenOperation(connection, FromV8String(connectionString), callback, backpointer);
+            Operation* operation = new OpenOperation(connection, FromV8String(connectionString), bulkCopy, callback, 
+                                                     backpointer);
             Operation::Add(operation);
 
             return scope.Close(Undefined());
@@ -25,4 +25,16 @@ namespace mssql {
 	// error returned when a string returns no data but it's not a NULL field
 	// ODBC returns SQL_NO_DATA so we translate this into an error and return it to node.js
     OdbcError OdbcError::NODE_SQL_NO_DATA = OdbcError( "IMNOD", "No data returned", 1 );
+
+    // errors opening or writing the file large object values are written to with the lobSink query option
+    OdbcError OdbcError::NODE_LOB_SINK_OPEN = OdbcError( "IMSNK", "Unable to open the LOB sink file", 2 );
+    OdbcError OdbcError::NODE_LOB_SINK_WRITE = OdbcError( "IMSNK", "Unable to write to the LOB sink file", 3 );
+    OdbcError OdbcError::NODE_LOB_SINK_COLUMN = OdbcError( "IMSNK", "The lobSink column is not a large object column", 7 );
+
+    // ODBC returns SQL_INVALID_HANDLE without any diagnostics to read, so this error stands in for them
+    OdbcError OdbcError::NODE_SQL_INVALID_HANDLE = OdbcError( "IMNOD", "Invalid ODBC handle", 4 );
+
+    // errors opening a connection for bulkLoad, whose bcp_* functions are loaded from the driver when first needed
+    OdbcError OdbcError::NODE_BCP_UNAVAILABLE = OdbcError( "IMBCP", "Unable to load the bulk copy functions from sqlncli11.dll", 5 );
+    OdbcError OdbcError::NODE_BCP_NOT_ENABLED = OdbcError( "IMBCP", "Connection was not opened with the bulkLoad option", 6 );
 }
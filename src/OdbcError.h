@@ -49,6 +49,12 @@ namespace mssql
 
         // list of msnodesql specific errors
         static OdbcError NODE_SQL_NO_DATA;
+        static OdbcError NODE_LOB_SINK_OPEN;
+        static OdbcError NODE_LOB_SINK_WRITE;
+        static OdbcError NODE_LOB_SINK_COLUMN;
+        static OdbcError NODE_SQL_INVALID_HANDLE;
+        static OdbcError NODE_BCP_UNAVAILABLE;
+        static OdbcError NODE_BCP_NOT_ENABLED;
 
     private:
 
@@ -23,6 +23,30 @@ namespace mssql
 {
     using namespace std;
 
+    // the first diagnostic record of any ODBC handle, including the descriptors a statement owns, which
+    // aren't wrapped by OdbcHandle as they are freed with the statement
+    inline shared_ptr<OdbcError> LastDiagError( SQLSMALLINT handleType, SQLHANDLE handle )
+    {
+        vector<wchar_t> buffer;
+
+        SQLWCHAR wszSqlState[6];
+        SQLINTEGER nativeError;
+        SQLSMALLINT actual;
+
+        SQLRETURN ret = SQLGetDiagRec(handleType, handle, 1, wszSqlState, &nativeError, NULL, 0, &actual);
+        assert( ret != SQL_INVALID_HANDLE );
+        assert( ret != SQL_NO_DATA );
+        assert( SQL_SUCCEEDED( ret ));
+
+        buffer.resize(actual+1);
+        ret = SQLGetDiagRec(handleType, handle, 1, wszSqlState, &nativeError, &buffer[0], actual + 1, &actual);
+        assert( SQL_SUCCEEDED( ret ));
+
+        string sqlstate = w2a(wszSqlState);
+        string message = w2a(buffer.data());
+        return make_shared<OdbcError>( sqlstate.c_str(), message.c_str(), nativeError );
+    }
+
     template<SQLSMALLINT HandleType>
     class OdbcHandle
     {
@@ -89,24 +113,7 @@ namespace mssql
 
         shared_ptr<OdbcError> LastError( void )
         {
-            vector<wchar_t> buffer;
-
-            SQLWCHAR wszSqlState[6];
-            SQLINTEGER nativeError;
-            SQLSMALLINT actual;
-
-            SQLRETURN ret = SQLGetDiagRec(HandleType, handle, 1, wszSqlState, &nativeError, NULL, 0, &actual);
-            assert( ret != SQL_INVALID_HANDLE );
-            assert( ret != SQL_NO_DATA );
-            assert( SQL_SUCCEEDED( ret ));
-
-            buffer.resize(actual+1);
-            ret = SQLGetDiagRec(HandleType, handle, 1, wszSqlState, &nativeError, &buffer[0], actual + 1, &actual);
-            assert( SQL_SUCCEEDED( ret ));
-
-            string sqlstate = w2a(wszSqlState);
-            string message = w2a(buffer.data());
-            return make_shared<OdbcError>( sqlstate.c_str(), message.c_str(), nativeError );
+            return LastDiagError( HandleType, handle );
         }
 
     private:
@@ -34,13 +34,37 @@
 
 namespace mssql
 {
-    // default precision and scale for date/time parameters
-    // (This may be updated for older server since they don't have as high a precision)
-    const int SQL_SERVER_2008_DEFAULT_DATETIME_PRECISION = 34;
-    const int SQL_SERVER_2008_DEFAULT_DATETIME_SCALE = 7;
+    namespace {
+
+        // values in a parameter arena are aligned for the widest of them
+        const size_t ARENA_ALIGNMENT = sizeof( int64_t );
+
+        size_t ArenaAligned( size_t size )
+        {
+            return ( size + ARENA_ALIGNMENT - 1 ) & ~( ARENA_ALIGNMENT - 1 );
+        }
+
+        // arena space taken by a parameter's value.  Nulls, Buffers and tables keep nothing in the arena.
+        size_t ArenaSize( Local<Value> p )
+        {
+            if( p->IsString() ) {
+                return ArenaAligned(( p.As<String>()->Length() + 1 ) * sizeof( uint16_t ));    // null terminator
+            }
+            if( p->IsBoolean() || p->IsNumber() ) {
+                return ArenaAligned( sizeof( int64_t ));
+            }
+            if( p->IsDate() ) {
+                return ArenaAligned( sizeof( SQL_SS_TIMESTAMPOFFSET_STRUCT ));
+            }
+            return 0;
+        }
+    }
 
     void OdbcOperation::InvokeBackground()
     {
+        ScopedCriticalSectionLock operationLock( connection->OperationCriticalSection() );
+
+        replacedResultset = connection->resultset;
         failed = !TryInvokeOdbc();
 
         if( failed ) {
@@ -84,7 +108,7 @@ namespace mssql
 
     bool OpenOperation::TryInvokeOdbc()
     {
-        return connection->TryOpen(connectionString);
+        return connection->TryOpen(connectionString, bulkCopy);
     }
 
     Handle<Value> OpenOperation::CreateCompletionArg()
@@ -93,10 +117,36 @@ namespace mssql
         return scope.Close(backpointer);
     }
 
-    QueryOperation::QueryOperation(shared_ptr<OdbcConnection> connection, const wstring& query, Handle<Object> callback) :
+    QueryOperation::QueryOperation(shared_ptr<OdbcConnection> connection, const wstring& query, Handle<Value> options, 
+                                   Handle<Object> callback) :
         OdbcOperation(connection, callback), 
-        query(query)
+        query(query),
+        arenaUsed(0)
+    {
+        this->options.FromValue( options );
+    }
+
+    SQLULEN QueryOperation::DeclaredSize( uint32_t param, size_t length, SQLULEN largest ) const
     {
+        if( param < options.paramSizes.size() && options.paramSizes[ param ] >= 0 ) {
+            SQLULEN size = options.paramSizes[ param ];
+            return size > largest ? 0 : size;
+        }
+
+        if( options.exactParamSizes ) {
+            return length > largest ? 0 : length;
+        }
+
+        return BucketSize( length, largest );
+    }
+
+    void* QueryOperation::Allocate( size_t size )
+    {
+        void* value = &arena[ arenaUsed ];
+        arenaUsed += ArenaAligned( size );
+        assert( arenaUsed <= arena.size() );
+
+        return value;
     }
 
     bool QueryOperation::ParameterErrorToUserCallback( uint32_t param, const char* error )
@@ -126,6 +176,16 @@ namespace mssql
 
         if( count > 0 ) {
 
+            // size the arena for every value first, so binding allocates nothing and no pointer into it moves
+            size_t arena_size = 0;
+            for( uint32_t i = 0; i < count; ++i ) {
+
+                arena_size += ArenaSize( node_params->Get( i ));
+            }
+            arena.resize( arena_size );
+            arenaUsed = 0;
+            params.reserve( count );
+
             for( uint32_t i = 0; i < count; ++i ) {
 
                 Local<Value> p = node_params->Get( i );
@@ -149,13 +209,11 @@ namespace mssql
                     binding.sql_type = SQL_WVARCHAR;
                     Local<String> str_param = p->ToString();
                     int str_len = str_param->Length();
-                    binding.buffer = new uint16_t[ str_len + 1 ];   // null terminator
+                    binding.buffer = Allocate(( str_len + 1 ) * sizeof( uint16_t ));   // null terminator
                     str_param->Write( static_cast<uint16_t*>( binding.buffer ));
-                    if( str_len > 4000 ) {
-                        binding.param_size = 0;     // max types require 0 precision
-                    }
-                    else {
-                        binding.param_size = str_len;
+                    binding.param_size = DeclaredSize( i, str_len, STRING_PARAM_MAX_SIZE );    // max types require 0 precision
+                    if( binding.param_size != 0 && binding.param_size < static_cast<SQLULEN>( str_len )) {
+                        return ParameterErrorToUserCallback( i, "Value is longer than its size in paramSizes" );
                     }
                     binding.buffer_len = str_len * sizeof( uint16_t );
                     binding.digits = 0;
@@ -166,9 +224,9 @@ namespace mssql
                     binding.js_type = ParamBinding::JS_BOOLEAN;
                     binding.c_type = SQL_C_BIT;
                     binding.sql_type = SQL_BIT;
-                    binding.buffer = new uint16_t;
-                    binding.buffer_len = sizeof( uint16_t );
-                    *static_cast<uint16_t*>( binding.buffer ) = p->BooleanValue();
+                    binding.buffer = Allocate( sizeof( SQLCHAR ));
+                    binding.buffer_len = sizeof( SQLCHAR );
+                    *static_cast<SQLCHAR*>( binding.buffer ) = p->BooleanValue();
                     binding.param_size = 1;
                     binding.digits = 0;
                     binding.indptr = binding.buffer_len;
@@ -178,7 +236,7 @@ namespace mssql
                     binding.js_type = ParamBinding::JS_INT;
                     binding.c_type = SQL_C_SLONG;
                     binding.sql_type = SQL_INTEGER;
-                    binding.buffer = new int32_t;
+                    binding.buffer = Allocate( sizeof( int32_t ));
                     binding.buffer_len = sizeof( int32_t );
                     *static_cast<int32_t*>( binding.buffer ) = p->Int32Value();
                     binding.param_size = sizeof( int32_t );
@@ -190,7 +248,7 @@ namespace mssql
                     binding.js_type = ParamBinding::JS_UINT;
                     binding.c_type = SQL_C_ULONG;
                     binding.sql_type = SQL_BIGINT;
-                    binding.buffer = new uint32_t;
+                    binding.buffer = Allocate( sizeof( uint32_t ));
                     binding.buffer_len = sizeof( uint32_t );
                     *static_cast<int32_t*>( binding.buffer ) = p->Uint32Value();
                     binding.param_size = sizeof( uint32_t );
@@ -214,7 +272,7 @@ namespace mssql
                         binding.js_type = ParamBinding::JS_NUMBER;
                         binding.c_type = SQL_C_SBIGINT;
                         binding.sql_type = SQL_BIGINT;
-                        binding.buffer = new int64_t;
+                        binding.buffer = Allocate( sizeof( int64_t ));
                         binding.buffer_len = sizeof( int64_t );
                         *static_cast<int64_t*>( binding.buffer ) = p->IntegerValue();
                         binding.param_size = sizeof( int64_t );
@@ -226,7 +284,7 @@ namespace mssql
                         binding.js_type = ParamBinding::JS_NUMBER;
                         binding.c_type = SQL_C_DOUBLE;
                         binding.sql_type = SQL_DOUBLE;
-                        binding.buffer = new double;
+                        binding.buffer = Allocate( sizeof( double ));
                         binding.buffer_len = sizeof( double );
                         *static_cast<double*>( binding.buffer ) = p->NumberValue();
                         binding.param_size = sizeof( double );
@@ -241,7 +299,8 @@ namespace mssql
                     assert( !dateObject.IsEmpty() );
                     // dates in JS are stored internally as ms count from Jan 1, 1970
                     double d = dateObject->NumberValue();
-                    SQL_SS_TIMESTAMPOFFSET_STRUCT* sql_tm = new SQL_SS_TIMESTAMPOFFSET_STRUCT;
+                    SQL_SS_TIMESTAMPOFFSET_STRUCT* sql_tm = 
+                        static_cast<SQL_SS_TIMESTAMPOFFSET_STRUCT*>( Allocate( sizeof( SQL_SS_TIMESTAMPOFFSET_STRUCT )));
                     TimestampColumn sql_date( d );
                     sql_date.ToTimestampOffset( *sql_tm );
 
@@ -256,6 +315,34 @@ namespace mssql
                     binding.digits = SQL_SERVER_2008_DEFAULT_DATETIME_SCALE;
                     binding.indptr = binding.buffer_len;
                 }
+                else if( p->IsObject() && p.As<Object>()->Has( String::NewSymbol( "tableType" ))) {
+
+                    // a table-valued parameter, as made by sql.tvp, whose rows are bound column-wise
+                    Local<Object> o = p.As<Object>();
+                    Local<Value> table_rows = o->Get( String::NewSymbol( "rows" ));
+                    if( !table_rows->IsArray() ) {
+
+                        return ParameterErrorToUserCallback( i, "Table-valued parameter rows must be an array" );
+                    }
+
+                    binding.js_type = ParamBinding::JS_TABLE;
+                    binding.table = make_shared<ParamArray>();
+                    if( !binding.table->Bind( table_rows.As<Array>(), false )) {
+
+                        std::stringstream table_error;
+                        table_error << "Row " << binding.table->errorRow + 1 << ", column " << binding.table->errorColumn + 1 
+                                    << ": " << binding.table->error;
+                        return ParameterErrorToUserCallback( i, table_error.str().c_str() );
+                    }
+                    binding.type_name = FromV8String( o->Get( String::NewSymbol( "tableType" ))->ToString() );
+                    binding.c_type = SQL_C_DEFAULT;
+                    binding.sql_type = SQL_SS_TABLE;
+                    binding.param_size = binding.table->rows;   // the most rows the parameter holds
+                    binding.digits = 0;
+                    binding.buffer = NULL;
+                    binding.buffer_len = 0;
+                    binding.indptr = binding.table->rows > 0 ? binding.table->rows : SQL_DEFAULT_PARAM;
+                }
                 else if( p->IsObject() && node::Buffer::HasInstance( p )) {
 
                     // TODO: Determine if we need something to keep the Buffer object from going
@@ -268,7 +355,10 @@ namespace mssql
                     binding.sql_type = SQL_VARBINARY;
                     binding.buffer = node::Buffer::Data( o );
                     binding.buffer_len = node::Buffer::Length( o );
-                    binding.param_size = binding.buffer_len;
+                    binding.param_size = DeclaredSize( i, binding.buffer_len, BINARY_PARAM_MAX_SIZE );
+                    if( binding.param_size != 0 && binding.param_size < static_cast<SQLULEN>( binding.buffer_len )) {
+                        return ParameterErrorToUserCallback( i, "Value is longer than its size in paramSizes" );
+                    }
                     binding.digits = 0;
                     binding.indptr = binding.buffer_len;
                 }
@@ -280,7 +370,7 @@ namespace mssql
 
                 }
 
-                params.push_back( move( binding ));
+                params.push_back( binding );
             }
         }
 
@@ -289,7 +379,7 @@ namespace mssql
 
     bool QueryOperation::TryInvokeOdbc()
     {
-        return connection->TryExecute( query, params );
+        return connection->TryExecute( query, params, options );
     }
 
     Handle<Value> QueryOperation::CreateCompletionArg()
@@ -298,6 +388,117 @@ namespace mssql
         return scope.Close(connection->GetMetaValue());
     }
 
+    bool ParamArrayOperation::ParameterErrorToUserCallback( uint32_t row, uint32_t param, const char* error )
+    {
+        params.columns.clear();
+
+        std::stringstream full_error;
+        full_error << "IMNOD: [msnodesql] Row " << row + 1 << ", parameter " << param + 1 << ": " << error;
+
+        Local<Object> err = Local<Object>::Cast( Exception::Error( String::New( full_error.str().c_str() )));
+        err->Set( String::NewSymbol( "sqlstate" ), String::New( "IMNOD" ));
+        err->Set( String::NewSymbol( "code" ), Integer::New( -1 ));
+
+        Local<Value> args[1];
+        args[0] = err;
+        int argc = 1;
+
+        // this is okay because we're still on the node.js thread, not on the background thread
+        callback->Call(Context::GetCurrent()->Global(), argc, args);
+
+        return false;
+    }
+
+    bool ParamArrayOperation::BindParameters( Handle<Array> node_rows )
+    {
+        if( node_rows->Length() == 0 ) {
+
+            return ParameterErrorToUserCallback( 0, 0, "A batch requires at least one row of parameters" );
+        }
+
+        if( !params.Bind( node_rows, true )) {
+
+            return ParameterErrorToUserCallback( params.errorRow, params.errorColumn, params.error );
+        }
+
+        return true;
+    }
+
+    bool ExecuteBatchOperation::TryInvokeOdbc()
+    {
+        status.assign( params.rows, SQL_PARAM_DIAG_UNAVAILABLE );
+
+        return connection->TryExecuteBatch( query, params.columns, params.rows, status.data(), rowcount );
+    }
+
+    Handle<Value> ExecuteBatchOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+
+        Local<Array> statuses = Array::New( static_cast<int>( params.rows ));
+        for( SQLULEN r = 0; r < params.rows; ++r ) {
+
+            const char* name;
+            switch( status[ r ] ) {
+                case SQL_PARAM_SUCCESS:
+                    name = "success";
+                    break;
+                case SQL_PARAM_SUCCESS_WITH_INFO:
+                    name = "info";
+                    break;
+                case SQL_PARAM_ERROR:
+                    name = "error";
+                    break;
+                case SQL_PARAM_UNUSED:
+                    name = "unused";
+                    break;
+                default:
+                    name = "unavailable";
+                    break;
+            }
+            statuses->Set( static_cast<uint32_t>( r ), String::NewSymbol( name ));
+        }
+
+        Local<Object> result = Object::New();
+        result->Set( String::NewSymbol( "rowcount" ), Number::New( static_cast<double>( rowcount )));
+        result->Set( String::NewSymbol( "status" ), statuses );
+
+        return scope.Close( result );
+    }
+
+    bool BulkInitOperation::TryInvokeOdbc()
+    {
+        return connection->TryBulkInit( table, hints );
+    }
+
+    Handle<Value> BulkInitOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+        return scope.Close( Undefined() );
+    }
+
+    bool BulkSendOperation::TryInvokeOdbc()
+    {
+        return connection->TryBulkSend( params.columns, params.rows, ordinals, sent );
+    }
+
+    Handle<Value> BulkSendOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+        return scope.Close( Integer::New( sent ));
+    }
+
+    bool BulkDoneOperation::TryInvokeOdbc()
+    {
+        return connection->TryBulkDone( rowcount );
+    }
+
+    Handle<Value> BulkDoneOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+        return scope.Close( Integer::New( rowcount ));
+    }
+
     bool ReadRowOperation::TryInvokeOdbc()
     {
         return connection->TryReadRow();
@@ -320,6 +521,78 @@ namespace mssql
         return scope.Close(connection->GetColumnValue());
     }
 
+    bool ReadRowValuesOperation::TryInvokeOdbc()
+    {
+        return connection->TryReadRowValues();
+    }
+
+    Handle<Value> ReadRowValuesOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+        return scope.Close(connection->GetRowValues());
+    }
+
+    bool ReadRowsOperation::TryInvokeOdbc()
+    {
+        bool read = connection->TryReadRows(count);
+
+        if( read && connection->PrefetchDepth() > 0 && !connection->resultset->BatchEndOfRows() && 
+            !connection->resultset->BatchMore() ) {
+
+            prefetch = connection->resultset;
+        }
+
+        return read;
+    }
+
+    Handle<Value> ReadRowsOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+        return scope.Close(connection->GetRows(objects));
+    }
+
+    void ReadRowsOperation::CompleteForeground()
+    {
+        // read the next batch while Javascript processes this one.  The callback handles the batch before it 
+        // returns, so the read ahead is queued first.  It only appends to the prefetched batches, leaving the 
+        // batch handed to Javascript alone.
+        if( prefetch ) {
+
+            Operation* operation = new PrefetchRowsOperation(connection, prefetch, count);
+            Operation::Add(operation);
+        }
+
+        OdbcOperation::CompleteForeground();
+    }
+
+    bool PrefetchRowsOperation::TryInvokeOdbc()
+    {
+        return connection->TryPrefetchRows(resultset, count);
+    }
+
+    Handle<Value> PrefetchRowsOperation::CreateCompletionArg()
+    {
+        assert( false );
+        HandleScope scope;
+        return scope.Close( Undefined() );
+    }
+
+    // override to not call a callback
+    void PrefetchRowsOperation::CompleteForeground()
+    {
+    }
+
+    bool ReadColumnarOperation::TryInvokeOdbc()
+    {
+        return connection->TryReadColumnar();
+    }
+
+    Handle<Value> ReadColumnarOperation::CreateCompletionArg()
+    {
+        HandleScope scope;
+        return scope.Close(connection->GetColumnar());
+    }
+
     bool ReadNextResultOperation::TryInvokeOdbc()
     {
         return connection->TryReadNextResult();
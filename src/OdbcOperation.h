@@ -20,8 +20,8 @@
 #pragma once
 
 #include "Operation.h"
-
-#include <list>
+#include "QueryOptions.h"
+#include "ParamArray.h"
 
 namespace mssql
 {
@@ -29,6 +29,7 @@ namespace mssql
     using namespace v8;
 
     class OdbcConnection;
+    class ResultSet;
 
     class OdbcOperation : public Operation
     {
@@ -43,6 +44,10 @@ namespace mssql
         bool failed;
         shared_ptr<OdbcError> failure;
 
+        // the connection's result set before the operation, which it may replace.  Keeping it here releases it 
+        // with the operation on the main thread, where the V8 handles it holds may be disposed.
+        shared_ptr<ResultSet> replacedResultset;
+
     public:
 
         OdbcOperation(shared_ptr<OdbcConnection> connection, Handle<Object> callback)
@@ -69,13 +74,15 @@ namespace mssql
     {
     private:
         wstring connectionString;
+        bool bulkCopy;
         Persistent<Object> backpointer;
 
     public:
-        OpenOperation(shared_ptr<OdbcConnection> connection, const wstring& connectionString, Handle<Object> callback, 
-                      Handle<Object> backpointer)
+        OpenOperation(shared_ptr<OdbcConnection> connection, const wstring& connectionString, bool bulkCopy, 
+                      Handle<Object> callback, Handle<Object> backpointer)
             : OdbcOperation(connection, callback), 
               connectionString(connectionString), 
+              bulkCopy(bulkCopy),
               backpointer(Persistent<Object>::New(backpointer))
         {
         }
@@ -106,7 +113,8 @@ namespace mssql
                 JS_UINT,
                 JS_NUMBER,
                 JS_DATE,
-                JS_BUFFER
+                JS_BUFFER,
+                JS_TABLE
             };
 
             JS_TYPE js_type;
@@ -114,10 +122,14 @@ namespace mssql
             SQLSMALLINT sql_type;
             SQLULEN param_size;
             SQLSMALLINT digits;
-            SQLPOINTER buffer;
+            SQLPOINTER buffer;      // within the arena, or a node.js Buffer's data
             SQLLEN buffer_len;
             SQLLEN indptr;
 
+            // rows and type name of a table-valued parameter
+            shared_ptr<ParamArray> table;
+            wstring type_name;
+
             ParamBinding( void ) :
                 js_type( JS_UNKNOWN ),
 
@@ -127,54 +139,13 @@ namespace mssql
                 indptr( SQL_NULL_DATA )
             {
             }
-
-            ~ParamBinding()
-            {
-                switch( js_type ) {
-                    // delete string array
-                    case JS_STRING:
-                        delete [] buffer;
-                        break;
-                    case JS_UNKNOWN:
-                    // we do nothing for buffers because it's a node.js Buffer object
-                    // which will be collected by v8
-                    case JS_BUFFER:
-                        break;
-                    // all other types just need scalar delete
-                    case JS_NULL:
-                    case JS_BOOLEAN:
-                    case JS_INT:
-                    case JS_UINT:
-                    case JS_NUMBER:
-                    case JS_DATE:
-                        delete buffer;
-                        break;
-                    default:
-                        assert( false );
-                        break;
-                }
-            }
-
-            ParamBinding( ParamBinding&& other )
-            {
-                js_type = other.js_type;
-                c_type = other.c_type;
-                sql_type = other.sql_type;
-                param_size = other.param_size;
-                digits = other.digits;
-                buffer = other.buffer;
-                buffer_len = other.buffer_len;
-                indptr = other.indptr;
-
-                other.buffer = NULL;
-                other.buffer_len = 0;
-            }
-
         };
 
-        typedef std::list<ParamBinding> param_bindings; // list because we only insert and traverse in-order
+        // bindings in parameter order.  Their values are kept in the operation's arena, except for Buffers, 
+        // whose data is bound where it is.
+        typedef vector<ParamBinding> param_bindings;
 
-        QueryOperation(shared_ptr<OdbcConnection> connection, const wstring& query, Handle<Object> callback);
+        QueryOperation(shared_ptr<OdbcConnection> connection, const wstring& query, Handle<Value> options, Handle<Object> callback);
 
         bool BindParameters( Handle<Array> node_params );                      
 
@@ -187,8 +158,132 @@ namespace mssql
 
     private:
 
+        // the size a string or binary parameter of length is declared with, following options.paramSizes.  Only
+        // a size given in paramSizes can be less than length, which BindParameters rejects.
+        SQLULEN DeclaredSize( uint32_t param, size_t length, SQLULEN largest ) const;
+
+        // takes the next size bytes of the arena, which BindParameters sizes for every value before binding any
+        void* Allocate( size_t size );
+
         wstring query;
         param_bindings params;
+        QueryOptions options;
+
+        // storage of all the parameter values, allocated once per operation
+        vector<char> arena;
+        size_t arenaUsed;
+    };
+
+    // an operation whose parameters are rows of values laid out column-wise
+    class ParamArrayOperation : public OdbcOperation
+    {
+    public:
+
+        ParamArrayOperation(shared_ptr<OdbcConnection> connection, Handle<Object> callback)
+            : OdbcOperation(connection, callback)
+        {
+        }
+
+        bool BindParameters( Handle<Array> rows );
+
+        // called by BindParameters when an error occurs.  It passes a node.js error to the user's callback.
+        bool ParameterErrorToUserCallback( uint32_t row, uint32_t param, const char* error );
+
+    protected:
+
+        ParamArray params;
+    };
+
+    // executes a statement once for every row of parameters, passing them to the driver as column-wise arrays
+    class ExecuteBatchOperation : public ParamArrayOperation
+    {
+    public:
+
+        ExecuteBatchOperation(shared_ptr<OdbcConnection> connection, const wstring& query, Handle<Object> callback)
+            : ParamArrayOperation(connection, callback),
+              query(query),
+              rowcount(0)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+
+    private:
+
+        wstring query;
+
+        // filled in by the driver for each row
+        vector<SQLUSMALLINT> status;
+        SQLLEN rowcount;
+    };
+
+    // starts a bulk copy into a table on the connection
+    class BulkInitOperation : public OdbcOperation
+    {
+    public:
+
+        BulkInitOperation(shared_ptr<OdbcConnection> connection, const wstring& table, const wstring& hints, 
+                          Handle<Object> callback)
+            : OdbcOperation(connection, callback),
+              table(table),
+              hints(hints)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+
+    private:
+
+        wstring table;
+        wstring hints;
+    };
+
+    // sends rows to the bulk copy started by BulkInitOperation and commits them as one batch
+    class BulkSendOperation : public ParamArrayOperation
+    {
+    public:
+
+        BulkSendOperation(shared_ptr<OdbcConnection> connection, Handle<Array> node_ordinals, Handle<Object> callback)
+            : ParamArrayOperation(connection, callback),
+              sent(0)
+        {
+            for( uint32_t i = 0; i < node_ordinals->Length(); ++i ) {
+                ordinals.push_back( node_ordinals->Get( i )->Int32Value() );
+            }
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+
+    private:
+
+        vector<int> ordinals;       // table column of each parameter, from 1
+        DBINT sent;
+    };
+
+    // ends the bulk copy, committing any rows not yet committed
+    class BulkDoneOperation : public OdbcOperation
+    {
+    public:
+
+        BulkDoneOperation(shared_ptr<OdbcConnection> connection, Handle<Object> callback)
+            : OdbcOperation(connection, callback),
+              rowcount(0)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+
+    private:
+
+        DBINT rowcount;
     };
     
     class ReadRowOperation : public OdbcOperation
@@ -224,6 +319,84 @@ namespace mssql
         Handle<Value> CreateCompletionArg() override;
     };
     
+    class ReadRowValuesOperation : public OdbcOperation
+    {
+    public:
+
+        ReadRowValuesOperation(shared_ptr<OdbcConnection> connection, Handle<Object> callback)
+            : OdbcOperation(connection, callback)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+    };
+    
+    class ReadRowsOperation : public OdbcOperation
+    {
+    private:
+
+        int count;
+        bool objects;
+
+        // result set to read ahead in as this batch is handed to Javascript, if any
+        shared_ptr<ResultSet> prefetch;
+
+    public:
+
+        ReadRowsOperation(shared_ptr<OdbcConnection> connection, int count, bool objects, Handle<Object> callback)
+            : OdbcOperation(connection, callback),
+              count(count),
+              objects(objects)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+
+        // override to queue reading ahead before the callback
+        void CompleteForeground() override;
+    };
+
+    class PrefetchRowsOperation : public OdbcOperation
+    {
+    private:
+
+        shared_ptr<ResultSet> resultset;
+        int count;
+
+    public:
+
+        PrefetchRowsOperation(shared_ptr<OdbcConnection> connection, shared_ptr<ResultSet> resultset, int count)
+            : OdbcOperation(connection, Handle<Object>()),
+              resultset(resultset),
+              count(count)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+
+        // override to not call a callback
+        void CompleteForeground() override;
+    };
+    
+    class ReadColumnarOperation : public OdbcOperation
+    {
+    public:
+        ReadColumnarOperation(shared_ptr<OdbcConnection> connection, Handle<Object> callback)
+            : OdbcOperation(connection, callback)
+        {
+        }
+
+        bool TryInvokeOdbc() override;
+
+        Handle<Value> CreateCompletionArg() override;
+    };
+
     class ReadNextResultOperation : public OdbcOperation
     {
     public:
@@ -0,0 +1,316 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: ParamArray.cpp
+// Contents: Rows of parameter values laid out column-wise for binding as arrays
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "ParamArray.h"
+#include "Column.h"
+
+#include <limits>
+#include <cmath>
+#include <float.h>      // _isnan and _finite
+
+// undo these tokens to use numeric_limits below
+#undef min
+#undef max
+
+namespace mssql
+{
+    namespace {
+
+        // declared sizes string and binary parameters are rounded up to, below their largest size
+        const SQLULEN PARAM_SIZE_BUCKETS[] = { 64, 256 };
+    }
+
+    SQLULEN BucketSize( size_t length, SQLULEN largest )
+    {
+        for( size_t b = 0; b < sizeof( PARAM_SIZE_BUCKETS ) / sizeof( PARAM_SIZE_BUCKETS[0] ); ++b ) {
+            if( length <= PARAM_SIZE_BUCKETS[ b ] ) {
+                return PARAM_SIZE_BUCKETS[ b ];
+            }
+        }
+        return length <= largest ? largest : 0;
+    }
+
+    bool ParamArray::Fail( uint32_t row, uint32_t column, const char* message )
+    {
+        columns.clear();
+        errorRow = row;
+        errorColumn = column;
+        error = message;
+
+        return false;
+    }
+
+    bool ParamArray::Bind( Handle<Array> node_rows, bool pack )
+    {
+        rows = node_rows->Length();
+
+        // every row must supply the same number of values as the first
+        uint32_t count = 0;
+        for( uint32_t r = 0; r < rows; ++r ) {
+
+            HandleScope scope;
+            Local<Value> row = node_rows->Get( r );
+            if( !row->IsArray() ) {
+
+                return Fail( r, 0, "Each row must be an array of values" );
+            }
+
+            uint32_t length = row.As<Array>()->Length();
+            if( r == 0 ) {
+
+                count = length;
+            }
+            else if( length != count ) {
+
+                return Fail( r, length < count ? length : count, "Row has a different number of values than the first row" );
+            }
+        }
+
+        columns.resize( count );
+        for( uint32_t i = 0; i < count; ++i ) {
+
+            if( !BindColumn( node_rows, i, pack, columns[ i ] )) {
+                // error already recorded by Fail
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool ParamArray::BindColumn( Handle<Array> node_rows, uint32_t param, bool pack, ParamColumn& column )
+    {
+        // the type of the column is decided by its non-null values, which must all agree.  Numbers widen from
+        // int to bigint to double as needed to hold every row.
+        enum ColumnKind { KIND_NULL, KIND_STRING, KIND_BOOLEAN, KIND_INT, KIND_BIGINT, KIND_NUMBER, KIND_DATE, KIND_BUFFER };
+
+        ColumnKind kind = KIND_NULL;
+        size_t max_length = 0;
+        size_t packed_size = 0;     // of the values one after another, should the column be packed
+
+        for( uint32_t r = 0; r < rows; ++r ) {
+
+            HandleScope scope;
+            Local<Value> p = node_rows->Get( r ).As<Array>()->Get( param );
+            ColumnKind value_kind;
+
+            if( p->IsNull() ) {
+
+                continue;
+            }
+            else if( p->IsString() ) {
+
+                value_kind = KIND_STRING;
+                size_t length = p.As<String>()->Length();
+                max_length = max( max_length, length );
+                packed_size += ( length + 1 ) * sizeof( uint16_t );
+            }
+            else if( p->IsBoolean() ) {
+
+                value_kind = KIND_BOOLEAN;
+            }
+            else if( p->IsInt32() ) {
+
+                value_kind = KIND_INT;
+            }
+            else if( p->IsNumber() ) {
+
+                double d = p->NumberValue();
+                if( _isnan( d ) || !_finite( d ) ) {
+
+                    return Fail( r, param, "Invalid number parameter" );
+                }
+                else if( d == floor( d ) && 
+                         d >= std::numeric_limits<int64_t>::min() && 
+                         d <= std::numeric_limits<int64_t>::max() ) {
+
+                    value_kind = KIND_BIGINT;
+                }
+                else {
+
+                    value_kind = KIND_NUMBER;
+                }
+            }
+            else if( p->IsDate() ) {
+
+                value_kind = KIND_DATE;
+            }
+            else if( p->IsObject() && node::Buffer::HasInstance( p )) {
+
+                value_kind = KIND_BUFFER;
+                size_t length = node::Buffer::Length( p.As<Object>() );
+                max_length = max( max_length, length );
+                packed_size += length;
+            }
+            else {
+
+                return Fail( r, param, "Invalid parameter type" );
+            }
+
+            bool numeric = value_kind >= KIND_INT && value_kind <= KIND_NUMBER;
+            if( kind == KIND_NULL ) {
+
+                kind = value_kind;
+            }
+            else if( numeric && kind >= KIND_INT && kind <= KIND_NUMBER ) {
+
+                kind = max( kind, value_kind );
+            }
+            else if( value_kind != kind ) {
+
+                return Fail( r, param, "Type differs from earlier rows" );
+            }
+        }
+
+        switch( kind ) {
+
+            case KIND_NULL:
+                column.c_type = SQL_C_CHAR;
+                column.sql_type = SQL_CHAR;
+                column.param_size = 1;
+                column.element_size = 1;
+                break;
+            case KIND_STRING:
+                column.c_type = SQL_C_WCHAR;
+                column.sql_type = SQL_WVARCHAR;
+                column.param_size = BucketSize( max_length, STRING_PARAM_MAX_SIZE );    // max types require 0 precision
+                column.element_size = ( max_length + 1 ) * sizeof( uint16_t );                              // null terminator
+                break;
+            case KIND_BOOLEAN:
+                column.c_type = SQL_C_BIT;
+                column.sql_type = SQL_BIT;
+                column.param_size = 1;
+                column.element_size = sizeof( SQLCHAR );
+                break;
+            case KIND_INT:
+                column.c_type = SQL_C_SLONG;
+                column.sql_type = SQL_INTEGER;
+                column.param_size = sizeof( int32_t );
+                column.element_size = sizeof( int32_t );
+                break;
+            case KIND_BIGINT:
+                column.c_type = SQL_C_SBIGINT;
+                column.sql_type = SQL_BIGINT;
+                column.param_size = sizeof( int64_t );
+                column.element_size = sizeof( int64_t );
+                break;
+            case KIND_NUMBER:
+                column.c_type = SQL_C_DOUBLE;
+                column.sql_type = SQL_DOUBLE;
+                column.param_size = sizeof( double );
+                column.element_size = sizeof( double );
+                break;
+            case KIND_DATE:
+                column.c_type = SQL_C_BINARY;
+                column.sql_type = SQL_SS_TIMESTAMPOFFSET;
+                column.param_size = SQL_SERVER_2008_DEFAULT_DATETIME_PRECISION;
+                column.digits = SQL_SERVER_2008_DEFAULT_DATETIME_SCALE;
+                column.element_size = sizeof( SQL_SS_TIMESTAMPOFFSET_STRUCT );
+                break;
+            case KIND_BUFFER:
+                column.c_type = SQL_C_BINARY;
+                column.sql_type = SQL_VARBINARY;
+                column.param_size = BucketSize( max_length, BINARY_PARAM_MAX_SIZE );
+                column.element_size = max( max_length, static_cast<size_t>( 1 ));
+                break;
+            default:
+                assert( false );
+                break;
+        }
+
+        column.indicators.assign( rows, SQL_NULL_DATA );
+        column.offsets.clear();
+
+        if( pack && ( kind == KIND_STRING || kind == KIND_BUFFER ) && rows * column.element_size > PACKED_COLUMN_BYTES ) {
+
+            column.data.resize( max( packed_size, static_cast<size_t>( 1 )));
+            column.offsets.resize( rows );
+        }
+        else {
+
+            column.data.resize( rows * column.element_size );
+        }
+
+        size_t offset = 0;
+        for( uint32_t r = 0; r < rows; ++r ) {
+
+            HandleScope scope;
+            Local<Value> p = node_rows->Get( r ).As<Array>()->Get( param );
+
+            if( column.Packed() ) {
+
+                column.offsets[ r ] = offset;
+            }
+            char* element = column.Value( r );
+
+            if( p->IsNull() ) {
+
+                continue;
+            }
+
+            switch( kind ) {
+
+                case KIND_STRING:
+                    column.indicators[ r ] = p.As<String>()->Write( reinterpret_cast<uint16_t*>( element )) * sizeof( uint16_t );
+                    offset += column.indicators[ r ] + sizeof( uint16_t );     // null terminator
+                    break;
+                case KIND_BOOLEAN:
+                    *reinterpret_cast<SQLCHAR*>( element ) = p->BooleanValue();
+                    column.indicators[ r ] = column.element_size;
+                    break;
+                case KIND_INT:
+                    *reinterpret_cast<int32_t*>( element ) = p->Int32Value();
+                    column.indicators[ r ] = column.element_size;
+                    break;
+                case KIND_BIGINT:
+                    *reinterpret_cast<int64_t*>( element ) = p->IntegerValue();
+                    column.indicators[ r ] = column.element_size;
+                    break;
+                case KIND_NUMBER:
+                    *reinterpret_cast<double*>( element ) = p->NumberValue();
+                    column.indicators[ r ] = column.element_size;
+                    break;
+                case KIND_DATE:
+                    {
+                        // Since JS dates have no timezone context, all dates are assumed to be UTC
+                        TimestampColumn sql_date( p->NumberValue() );
+                        sql_date.ToTimestampOffset( *reinterpret_cast<SQL_SS_TIMESTAMPOFFSET_STRUCT*>( element ));
+                        column.indicators[ r ] = column.element_size;
+                    }
+                    break;
+                case KIND_BUFFER:
+                    {
+                        // copied, since the Buffer may be collected before the batch runs
+                        Local<Object> o = p.As<Object>();
+                        size_t length = node::Buffer::Length( o );
+                        memcpy( element, node::Buffer::Data( o ), length );
+                        column.indicators[ r ] = length;
+                        offset += length;
+                    }
+                    break;
+                default:
+                    assert( false );
+                    break;
+            }
+        }
+
+        return true;
+    }
+}
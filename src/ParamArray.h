@@ -0,0 +1,116 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: ParamArray.h
+// Contents: Rows of parameter values laid out column-wise for binding as arrays
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+namespace mssql
+{
+    using namespace std;
+    using namespace v8;
+
+    // default precision and scale for date/time parameters
+    // (This may be updated for older server since they don't have as high a precision)
+    const int SQL_SERVER_2008_DEFAULT_DATETIME_PRECISION = 34;
+    const int SQL_SERVER_2008_DEFAULT_DATETIME_SCALE = 7;
+
+    // largest declared sizes of string (in characters) and binary parameters before they must be max types
+    const SQLULEN STRING_PARAM_MAX_SIZE = 4000;
+    const SQLULEN BINARY_PARAM_MAX_SIZE = 8000;
+
+    // the declared size of a string or binary parameter of length, rounded up to 64, 256 or largest so one plan 
+    // serves values of many lengths.  0 declares a max type.
+    SQLULEN BucketSize( size_t length, SQLULEN largest );
+
+    // Rows of parameter values laid out column-wise, one contiguous array of values and indicators per 
+    // column, as bound by executeBatch, bulkLoad and table-valued parameters.  The type of each column 
+    // comes from its non-null values.
+    //
+    // Values are laid out at a fixed stride of the column's longest value, so one long string or Buffer makes
+    // every row of its column cost that much.  When packing is allowed, a column that would take more than 
+    // PACKED_COLUMN_BYTES this way has its values packed one after another instead, found through offsets.  
+    // executeBatch sends such a column a value at a time at execution (SQL_DATA_AT_EXEC) and bulkLoad points 
+    // bcp at each value.  Table-valued parameters are always laid out at a fixed stride.
+    class ParamArray
+    {
+    public:
+
+        // one column with its values for every row laid out contiguously
+        struct ParamColumn {
+
+            SQLSMALLINT c_type;
+            SQLSMALLINT sql_type;
+            SQLULEN param_size;
+            SQLSMALLINT digits;
+            SQLLEN element_size;
+            vector<char> data;
+            vector<SQLLEN> indicators;
+            vector<size_t> offsets;     // where each row's value starts in data when the column is packed
+
+            bool Packed( void ) const
+            {
+                return !offsets.empty();
+            }
+
+            // the value of row, indicators[ row ] bytes long unless null
+            char* Value( SQLULEN row )
+            {
+                return data.data() + ( Packed() ? offsets[ row ] : row * element_size );
+            }
+
+            ParamColumn( void ) :
+                c_type( SQL_C_CHAR ),
+                sql_type( SQL_CHAR ),
+                param_size( 1 ),
+                digits( 0 ),
+                element_size( 0 )
+            {
+            }
+        };
+
+        typedef vector<ParamColumn> param_columns;
+
+        param_columns columns;
+        SQLULEN rows;
+
+        // where Bind failed and why, to report back to Javascript
+        uint32_t errorRow;
+        uint32_t errorColumn;
+        const char* error;
+
+        ParamArray( void ) :
+            rows( 0 ),
+            errorRow( 0 ),
+            errorColumn( 0 ),
+            error( NULL )
+        {
+        }
+
+        // a column laid out at a fixed stride larger than this is packed when Bind is allowed to pack
+        static const size_t PACKED_COLUMN_BYTES = 16 * 1024 * 1024;
+
+        // lays out an array of rows, each an array of values, packing long columns if pack is true.  Must 
+        // be called on the node.js thread.
+        bool Bind( Handle<Array> rows, bool pack );
+
+    private:
+
+        bool BindColumn( Handle<Array> rows, uint32_t param, bool pack, ParamColumn& column );
+        bool Fail( uint32_t row, uint32_t column, const char* message );
+    };
+}
@@ -0,0 +1,150 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: QueryOptions.h
+// Contents: Options given to a query from Javascript that control how its results are read
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+namespace mssql
+{
+    using namespace std;
+    using namespace v8;
+
+    struct QueryOptions
+    {
+        // number of batches of rows read ahead while Javascript processes the last batch returned
+        int prefetch;
+
+        // size of the pieces (characters for strings, bytes for binary) that large object values are 
+        // returned in, to be streamed by the caller.  0 reads each value whole.
+        int lobChunkSize;
+
+        // read char and varchar columns in the client code page (SQL_C_CHAR), half the size of UTF-16 for 
+        // ASCII text, and convert them to UTF-16 only when they aren't ASCII
+        bool narrowVarchar;
+
+        // bigint: 'string' returns bigint values exactly as strings, and in columns as pairs of 32 bit 
+        // halves, rather than as numbers that lose precision above 2^53
+        bool bigintAsString;
+
+        // decimal: 'string' returns decimal, numeric and money values exactly as strings, formatted from 
+        // SQL_NUMERIC_STRUCT, rather than as numbers
+        bool decimalAsString;
+
+        // dates: 'date' returns dates as Date objects with a nanosecondsDelta property for the 100ns part 
+        // (the default), 'plain' as Date objects without it, and 'number' as milliseconds since Jan 1, 1970 UTC
+        enum Dates
+        {
+            FullDates,
+            PlainDates,
+            NumberDates
+        };
+        Dates dates;
+
+        // a column (lobSink.column) whose values are written one after another to a file (lobSink.path) 
+        // on the background thread.  The number of bytes written is returned for each value instead.
+        int lobSinkColumn;
+        wstring lobSinkPath;
+
+        // paramSizes: how string and binary parameters are declared.  By default their size is rounded up to a
+        // bucket, so the server compiles one plan per bucket rather than one per length.  'exact' declares each
+        // value's length, and an array gives the declared size of each parameter in turn (0 for max), with 
+        // null or a missing entry falling back to a bucket.
+        bool exactParamSizes;
+        vector<int> paramSizes;     // -1 where no size is given
+
+        static const int DEFAULT_PREFETCH = 1;
+
+        QueryOptions( void ) :
+            prefetch( DEFAULT_PREFETCH ),
+            lobChunkSize( 0 ),
+            narrowVarchar( false ),
+            bigintAsString( false ),
+            decimalAsString( false ),
+            dates( FullDates ),
+            lobSinkColumn( -1 ),
+            exactParamSizes( false )
+        {
+        }
+
+        // read the options from a JS object.  Anything not given keeps its default.
+        void FromValue( Handle<Value> value )
+        {
+            HandleScope scope;
+
+            if( !value->IsObject() ) {
+                return;
+            }
+
+            Local<Object> options = value.As<Object>();
+
+            Local<Value> p = options->Get( String::NewSymbol( "prefetch" ));
+            if( p->IsNumber() && p->Int32Value() >= 0 ) {
+                prefetch = p->Int32Value();
+            }
+
+            Local<Value> l = options->Get( String::NewSymbol( "lobChunkSize" ));
+            if( l->IsNumber() && l->Int32Value() >= 0 ) {
+                lobChunkSize = l->Int32Value();
+            }
+
+            narrowVarchar = options->Get( String::NewSymbol( "narrowVarchar" ))->BooleanValue();
+
+            Local<Value> b = options->Get( String::NewSymbol( "bigint" ));
+            if( b->IsString() ) {
+                bigintAsString = b->ToString()->Equals( String::NewSymbol( "string" ));
+            }
+
+            Local<Value> d = options->Get( String::NewSymbol( "decimal" ));
+            if( d->IsString() ) {
+                decimalAsString = d->ToString()->Equals( String::NewSymbol( "string" ));
+            }
+
+            Local<Value> t = options->Get( String::NewSymbol( "dates" ));
+            if( t->IsString() ) {
+                if( t->ToString()->Equals( String::NewSymbol( "plain" ))) {
+                    dates = PlainDates;
+                }
+                else if( t->ToString()->Equals( String::NewSymbol( "number" ))) {
+                    dates = NumberDates;
+                }
+            }
+
+            Local<Value> s = options->Get( String::NewSymbol( "lobSink" ));
+            if( s->IsObject() ) {
+                Local<Value> column = s.As<Object>()->Get( String::NewSymbol( "column" ));
+                Local<Value> path = s.As<Object>()->Get( String::NewSymbol( "path" ));
+                if( column->IsNumber() && column->Int32Value() >= 0 && path->IsString() ) {
+                    lobSinkColumn = column->Int32Value();
+                    lobSinkPath = FromV8String( path->ToString() );
+                }
+            }
+
+            Local<Value> z = options->Get( String::NewSymbol( "paramSizes" ));
+            if( z->IsString() ) {
+                exactParamSizes = z->ToString()->Equals( String::NewSymbol( "exact" ));
+            }
+            else if( z->IsArray() ) {
+                Local<Array> sizes = z.As<Array>();
+                for( uint32_t i = 0; i < sizes->Length(); ++i ) {
+                    Local<Value> size = sizes->Get( i );
+                    paramSizes.push_back( size->IsNumber() && size->Int32Value() >= 0 ? size->Int32Value() : -1 );
+                }
+            }
+        }
+    };
+}
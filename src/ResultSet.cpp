@@ -19,11 +19,100 @@
 
 #include "stdafx.h"
 #include "ResultSet.h"
+#include "Text.h"
 
 namespace mssql
 {
     using namespace v8;
 
+    namespace {
+
+        void DeleteBinaryValue( char* data, void* hint )
+        {
+            delete [] data;
+        }
+
+        // space to convert strings in, only used on the node.js thread
+        vector<char> narrowed;
+        vector<uint16_t> widened;
+
+        // The characters of an external string, in memory allocated with new char[] that the string owns.  
+        // The memory is reported to V8 so that it counts towards when to collect garbage.
+        template<typename Resource, typename Char>
+        class ExternalText : public Resource
+        {
+        public:
+
+            ExternalText( char* memory, size_t length ) :
+                memory( memory ),
+                size( length )
+            {
+                V8::AdjustAmountOfExternalAllocatedMemory( static_cast<intptr_t>( size * sizeof( Char )));
+            }
+
+            ~ExternalText( void )
+            {
+                delete [] memory;
+                V8::AdjustAmountOfExternalAllocatedMemory( -static_cast<intptr_t>( size * sizeof( Char )));
+            }
+
+            const Char* data( void ) const
+            {
+                return reinterpret_cast<const Char*>( memory );
+            }
+
+            size_t length( void ) const
+            {
+                return size;
+            }
+
+        private:
+
+            char* memory;
+            size_t size;
+        };
+
+        typedef ExternalText<String::ExternalStringResource, uint16_t> ExternalTwoByteText;
+        typedef ExternalText<String::ExternalAsciiStringResource, char> ExternalAsciiText;
+
+        // a string that takes text, allocated with new char[], as its memory.  ASCII text is narrowed to 
+        // a one byte string instead, which takes half the memory.
+        Handle<Value> NewExternalString( char* text, size_t length )
+        {
+            const uint16_t* characters = reinterpret_cast<const uint16_t*>( text );
+
+            if( IsAscii( characters, length )) {
+
+                char* narrowedText = new char[ length ];
+                NarrowAscii( characters, length, narrowedText );
+                delete [] text;
+                return String::NewExternal( new ExternalAsciiText( narrowedText, length ));
+            }
+
+            return String::NewExternal( new ExternalTwoByteText( text, length ));
+        }
+
+        // ASCII text is created as a one byte string, which takes half the memory of a two byte one
+        Handle<Value> NewString( const uint16_t* text, size_t length )
+        {
+            if( length >= ResultSet::EXTERNAL_STRING_MIN_LENGTH ) {
+
+                char* copy = new char[ length * sizeof( uint16_t ) ];
+                memcpy( copy, text, length * sizeof( uint16_t ));
+                return NewExternalString( copy, length );
+            }
+
+            if( IsAscii( text, length )) {
+
+                narrowed.resize( length );
+                NarrowAscii( text, length, narrowed.data() );
+                return String::New( narrowed.data(), static_cast<int>( length ));
+            }
+
+            return String::New( text, static_cast<int>( length ));
+        }
+    }
+
     Handle<Value> ResultSet::MetaToValue()
     {
         HandleScope scope;
@@ -92,4 +181,239 @@ namespace mssql
 
         return scope.Close(metadata);
     }
+
+    Handle<Value> ResultSet::RowToValue(size_t row)
+    {
+        HandleScope scope;
+
+        size_t columns = batch.RowColumns(row);
+        Local<Array> values = Array::New(columns);
+        for (uint32_t i = 0; i < columns; ++i)
+        {
+            values->Set(i, batch.CellToValue(batch.GetCell(row, i)));
+        }
+
+        return scope.Close(values);
+    }
+
+    Handle<Value> ResultSet::BatchToValue()
+    {
+        HandleScope scope;
+
+        Local<Array> rows = Array::New(BatchSize());
+        for (uint32_t i = 0; i < BatchSize(); ++i)
+        {
+            rows->Set(i, RowToValue(batchFirst + i));
+        }
+
+        return scope.Close(rows);
+    }
+
+    Handle<Value> ResultSet::BatchToObjects()
+    {
+        HandleScope scope;
+
+        vector<Local<String>> names;
+        names.reserve(propertyNames.size());
+        for (size_t c = 0; c < propertyNames.size(); ++c)
+        {
+            names.push_back(New(propertyNames[c].c_str()));
+        }
+
+        // every row object of every batch is created from the same template so they all share one shape.  
+        // MakePropertyNames runs on the background thread, so the template is made here on the first batch.
+        if (shape.IsEmpty())
+        {
+            shape = Persistent<ObjectTemplate>::New(ObjectTemplate::New());
+            for (size_t c = 0; c < names.size(); ++c)
+            {
+                shape->Set(names[c], Null());
+            }
+        }
+
+        Local<Array> rows = Array::New(BatchSize());
+        for (uint32_t i = 0; i < BatchSize(); ++i)
+        {
+            HandleScope rowScope;
+
+            size_t columns = batch.RowColumns(batchFirst + i);
+            Local<Object> row = shape->NewInstance();
+            for (size_t c = 0; c < columns; ++c)
+            {
+                row->Set(names[c], batch.CellToValue(batch.GetCell(batchFirst + i, c)));
+            }
+
+            rows->Set(i, row);
+        }
+
+        return scope.Close(rows);
+    }
+
+    void ResultSet::MakePropertyNames()
+    {
+        propertyNames.clear();
+        propertyNames.reserve(metadata.size());
+
+        for (size_t c = 0; c < metadata.size(); ++c)
+        {
+            wstring name = metadata[c].name;
+            if (name.empty() || find(propertyNames.begin(), propertyNames.end(), name) != propertyNames.end())
+            {
+                long long extra = 0;
+                name = L"Column" + to_wstring(static_cast<long long>(c));
+                while (find(propertyNames.begin(), propertyNames.end(), name) != propertyNames.end())
+                {
+                    name = L"Column" + to_wstring(static_cast<long long>(c)) + L"_" + to_wstring(extra++);
+                }
+            }
+
+            propertyNames.push_back(name);
+        }
+    }
+
+    void ResultSet::RowBatch::AppendDate( SQL_SS_TIMESTAMPOFFSET_STRUCT const& date, Cell::Type type )
+    {
+        assert( type == Cell::Date || type == Cell::PlainDate || type == Cell::Number );
+
+        TimestampColumn timestamp( date );
+
+        Cell& cell = Append( type );
+        cell.value.number = timestamp.Milliseconds();
+        cell.nanosecondsDelta = timestamp.NanosecondsDelta();
+    }
+
+    char* ResultSet::RowBatch::ReserveBytes( size_t length )
+    {
+        // keep strings aligned for reading as UTF-16
+        arenaUsed += arenaUsed % 2;
+
+        arena.resize( arenaUsed + length );
+
+        return arena.data() + arenaUsed;
+    }
+
+    void ResultSet::RowBatch::AppendBytes( Cell::Type type, size_t length, bool more )
+    {
+        assert( type == Cell::String || type == Cell::AnsiString );
+        assert( arenaUsed + length <= arena.size() );
+
+        size_t offset = arenaUsed;
+        arenaUsed += length;
+
+        Cell& cell = Append( type );
+        cell.more = more;
+        cell.value.bytes.offset = static_cast<uint32_t>( offset );
+        cell.value.bytes.length = static_cast<uint32_t>( length );
+    }
+
+    void ResultSet::RowBatch::AppendOwned( Cell::Type type, shared_ptr<BinaryValue> value, size_t length, bool more )
+    {
+        assert( type == Cell::Binary || type == Cell::ExternalString );
+
+        Cell& cell = Append( type );
+        cell.more = more;
+        cell.value.bytes.offset = static_cast<uint32_t>( binaries.size() );
+        cell.value.bytes.length = static_cast<uint32_t>( length );
+
+        binaries.push_back( value );
+    }
+
+    Handle<Value> ResultSet::RowBatch::CellToValue( const Cell& cell )
+    {
+        HandleScope scope;
+
+        switch( cell.type ) {
+        case Cell::Boolean:
+            return scope.Close( Boolean::New( cell.value.boolean ));
+        case Cell::Int:
+            return scope.Close( Integer::New( cell.value.integer ));
+        case Cell::Number:
+            return scope.Close( Number::New( cell.value.number ));
+        case Cell::Int64:
+            return scope.Close( String::New( to_string( static_cast<long long>( cell.value.bigint )).c_str() ));
+        case Cell::Date:
+            return scope.Close( TimestampColumn( cell.value.number, cell.nanosecondsDelta ).ToValue() );
+        case Cell::PlainDate:
+            return scope.Close( Date::New( cell.value.number ));
+        case Cell::String:
+            if( cell.value.bytes.length == 0 ) {
+                return scope.Close( String::Empty() );
+            }
+            return scope.Close( NewString( reinterpret_cast<const uint16_t*>( arena.data() + cell.value.bytes.offset ),
+                                           cell.value.bytes.length / sizeof( uint16_t )));
+        case Cell::AnsiString:
+            {
+                const char* text = arena.data() + cell.value.bytes.offset;
+                if( IsAscii( text, cell.value.bytes.length )) {
+                    return scope.Close( String::New( text, cell.value.bytes.length ));
+                }
+                WidenAnsi( text, cell.value.bytes.length, widened );
+                return scope.Close( String::New( widened.data(), static_cast<int>( widened.size() )));
+            }
+        case Cell::Binary:
+            {
+                // the Buffer takes the memory the value was read into, and node accounts for it as external memory
+                char* data = binaries[ cell.value.bytes.offset ]->Release();
+                return scope.Close( node::Buffer::New( data, cell.value.bytes.length, DeleteBinaryValue, nullptr )->handle_ );
+            }
+        case Cell::ExternalString:
+            {
+                // the string takes the memory the value was read into, without copying it into the V8 heap
+                char* data = binaries[ cell.value.bytes.offset ]->Release();
+                return scope.Close( NewExternalString( data, cell.value.bytes.length / sizeof( uint16_t )));
+            }
+        default:
+            return scope.Close( Null() );
+        }
+    }
+
+    void ResultSet::RowBatch::AppendCellTo( const Cell& cell, ColumnarColumn& columnar ) const
+    {
+        switch( cell.type ) {
+        case Cell::Boolean:
+            columnar.AppendBool( cell.value.boolean );
+            break;
+        case Cell::Int:
+            columnar.AppendInt( cell.value.integer );
+            break;
+        case Cell::Int64:
+            columnar.AppendInt64( cell.value.bigint );
+            break;
+        case Cell::Number:
+        case Cell::Date:        // the nanoseconds delta is dropped since the column only holds the milliseconds
+        case Cell::PlainDate:
+            columnar.AppendNumber( cell.value.number );
+            break;
+        case Cell::String:
+            columnar.AppendBytes( arena.data() + cell.value.bytes.offset, cell.value.bytes.length, cell.more );
+            break;
+        case Cell::AnsiString:     // columns are stored as UTF-16
+            {
+                vector<uint16_t> text;
+                WidenAnsi( arena.data() + cell.value.bytes.offset, cell.value.bytes.length, text );
+                columnar.AppendBytes( text.data(), text.size() * sizeof( uint16_t ), cell.more );
+            }
+            break;
+        case Cell::Binary:
+        case Cell::ExternalString:
+            columnar.AppendBytes( binaries[ cell.value.bytes.offset ]->Data(), cell.value.bytes.length, cell.more );
+            break;
+        default:
+            columnar.AppendNull();
+            break;
+        }
+    }
+
+    Handle<Value> ResultSet::ColumnarToValue()
+    {
+        HandleScope scope;
+
+        Local<Array> columns = Array::New(columnar.size());
+        for (uint32_t i = 0; i < columnar.size(); ++i)
+        {
+            columns->Set(i, columnar[i].ToValue());
+        }
+
+        return scope.Close(columns);
+    }
 }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Column.h"
+#include "Columnar.h"
 
 namespace mssql
 {
@@ -30,6 +31,9 @@ namespace mssql
 
     public:
 
+        // strings at least this many characters long are created as external strings, outside the V8 heap
+        static const size_t EXTERNAL_STRING_MIN_LENGTH = 8192;
+
         struct ColumnDefinition
         {
             wstring name;
@@ -39,14 +43,47 @@ namespace mssql
             SQLSMALLINT decimalDigits;
             SQLSMALLINT nullable;
             wstring udtTypeName;
+
+            // how a column read as a string is retrieved, worked out once when the columns are described
+            SQLLEN displaySize;     // characters in the longest value
+            bool lob;               // size unbounded, so the value is read in pieces
+        };
+
+        // column-wise array a column is bound to when the result set is fetched a block of rows at a time
+        struct BoundColumn
+        {
+            SQLSMALLINT cType;
+            SQLLEN elementSize;
+            vector<char> data;
+            vector<SQLLEN> indicators;
+
+            BoundColumn( void ) :
+                cType( SQL_C_DEFAULT ),
+                elementSize( 0 )
+            {
+            }
+
+            const char* Value( SQLULEN row ) const
+            {
+                return data.data() + row * elementSize;
+            }
         };
 
         ResultSet(int columns) 
             : rowcount(0),
-              endOfRows(true)
+              endOfRows(true),
+              batchFirst(0),
+              batchEnd(0),
+              rowsFetched(0),
+              blockRow(0)
         {
             metadata.resize(columns);
-            column.reset();
+        }
+
+        // a result set is only released on the main thread, as the operation that replaced it holds it until then
+        ~ResultSet()
+        {
+            shape.Dispose();
         }
   
         ColumnDefinition& GetMetadata(int column)
@@ -61,16 +98,306 @@ namespace mssql
 
         Handle<Value> MetaToValue();
 
-        void SetColumn(shared_ptr<Column> column)
+        // true when the columns are bound and rows are fetched a block at a time
+        bool IsBlockCursor() const
+        {
+            return !bound.empty();
+        }
+
+        const BoundColumn& GetBoundColumn(int column) const
+        {
+            return bound[column];
+        }
+
+        // index of the current row within the block fetched
+        SQLULEN BlockRow() const
+        {
+            return blockRow;
+        }
+
+        // the value of one column of a row.  Fixed width values are held in the cell, and strings (UTF-16)
+        // and binary values in the arena of the batch the cell belongs to.
+        struct Cell
+        {
+            enum Type
+            {
+                Null,
+                Boolean,
+                Int,
+                Number,
+                Int64,      // bigint returned exactly as a string
+                Date,       // milliseconds since Jan 1, 1970 UTC in number
+                PlainDate,  // a Date without the nanosecondsDelta property
+                String,
+                Binary,
+                AnsiString,     // varchar read as SQL_C_CHAR in the client code page
+                ExternalString  // UTF-16 read into a BinaryValue, which becomes the memory of an external string
+            };
+
+            uint8_t type;
+            bool more;                  // a LOB value with more data to retrieve via ReadColumn
+            int32_t nanosecondsDelta;   // dates only, see TimestampColumn
+
+            union
+            {
+                bool boolean;
+                int32_t integer;
+                double number;
+                int64_t bigint;
+                struct
+                {
+                    uint32_t offset;
+                    uint32_t length;    // in bytes
+                } bytes;
+            } value;
+        };
+
+        // memory a binary value or long string is read into, handed to the node Buffer or the external 
+        // string created from it
+        class BinaryValue
+        {
+        public:
+
+            explicit BinaryValue( size_t capacity ) :
+                data( new char[ capacity ] )
+            {
+            }
+
+            ~BinaryValue( void )
+            {
+                delete [] data;
+            }
+
+            char* Data( void ) const
+            {
+                return data;
+            }
+
+            // move the first used bytes into new memory of capacity bytes
+            void Resize( size_t used, size_t capacity )
+            {
+                char* resized = new char[ capacity ];
+                memcpy( resized, data, used );
+                delete [] data;
+                data = resized;
+            }
+
+            // the caller becomes responsible for deleting the memory
+            char* Release( void )
+            {
+                char* released = data;
+                data = nullptr;
+                return released;
+            }
+
+        private:
+
+            char* data;
+
+            BinaryValue( const BinaryValue& );
+            BinaryValue& operator=( const BinaryValue& );
+        };
+
+        // A batch of rows filled on the background thread and converted to JS values in one pass on 
+        // the node.js thread.  The cells of all the rows are stored one after another, along with the 
+        // bytes of their strings, and Clear keeps that memory to fill the batch again.  Binary values
+        // are each read into their own memory, which becomes the memory of the Buffer returned, and so
+        // are strings long enough to be external strings.
+        struct RowBatch
+        {
+            vector<Cell> cells;
+            vector<size_t> rowStarts;       // index of the first cell of each row
+            vector<char> arena;             // string values of the cells
+            vector<shared_ptr<BinaryValue>> binaries;   // binary values and external strings of the cells
+            size_t arenaUsed;               // end of the values appended, before any space reserved
+            bool endOfRows;                 // the cursor reached the end of the rows while filling this batch
+            shared_ptr<OdbcError> error;    // set when reading ahead into this batch failed
+
+            RowBatch( void ) :
+                arenaUsed( 0 ),
+                endOfRows( false )
+            {
+            }
+
+            void Clear( void )
+            {
+                cells.clear();
+                rowStarts.clear();
+                arena.clear();
+                arenaUsed = 0;
+                binaries.clear();
+                endOfRows = false;
+                error.reset();
+            }
+
+            size_t Rows( void ) const
+            {
+                return rowStarts.size();
+            }
+
+            // columns read of a row, which is fewer than the result set has when the row ends at a LOB
+            size_t RowColumns( size_t row ) const
+            {
+                return ( row + 1 < rowStarts.size() ? rowStarts[ row + 1 ] : cells.size() ) - rowStarts[ row ];
+            }
+
+            const Cell& GetCell( size_t row, size_t column ) const
+            {
+                return cells[ rowStarts[ row ] + column ];
+            }
+
+            void StartRow( void )
+            {
+                rowStarts.push_back( cells.size() );
+            }
+
+            void AppendNull( void )
+            {
+                Append( Cell::Null );
+            }
+
+            void AppendBool( bool value )
+            {
+                Append( Cell::Boolean ).value.boolean = value;
+            }
+
+            void AppendInt( int32_t value )
+            {
+                Append( Cell::Int ).value.integer = value;
+            }
+
+            void AppendNumber( double value )
+            {
+                Append( Cell::Number ).value.number = value;
+            }
+
+            void AppendInt64( int64_t value )
+            {
+                Append( Cell::Int64 ).value.bigint = value;
+            }
+
+            // losing precision above 2^53, as a Javascript number does
+            void AppendInt64AsNumber( int64_t value )
+            {
+                AppendNumber( static_cast<double>( value ));
+            }
+
+            // as a Date, a PlainDate or a Number of milliseconds since Jan 1, 1970 UTC
+            void AppendDate( SQL_SS_TIMESTAMPOFFSET_STRUCT const& date, Cell::Type type = Cell::Date );
+
+            // space for a string or binary value to be read directly into the arena and then appended 
+            // with AppendBytes.  The pointer is only valid until the next call on the batch.  Reserving 
+            // again before appending keeps what was read, so a value may be read in growing pieces.
+            char* ReserveBytes( size_t length );
+
+            // append the first length bytes of the space last reserved as a String or AnsiString cell
+            void AppendBytes( Cell::Type type, size_t length, bool more );
+
+            // append a Binary or ExternalString cell of length bytes read into value
+            void AppendOwned( Cell::Type type, shared_ptr<BinaryValue> value, size_t length, bool more );
+
+            void AppendCopy( Cell::Type type, const void* bytes, size_t length, bool more )
+            {
+                memcpy( ReserveBytes( length ), bytes, length );
+                AppendBytes( type, length, more );
+            }
+
+            // true when the last column of the last row read has more data to retrieve via ReadColumn
+            bool More() const
+            {
+                return !cells.empty() && cells.back().more;
+            }
+
+            // binary values are handed to the Buffer returned, so each cell may only be converted once
+            Handle<Value> CellToValue( const Cell& cell );
+
+            void AppendCellTo( const Cell& cell, ColumnarColumn& columnar ) const;
+
+            void swap( RowBatch& other )
+            {
+                cells.swap( other.cells );
+                rowStarts.swap( other.rowStarts );
+                arena.swap( other.arena );
+                std::swap( arenaUsed, other.arenaUsed );
+                binaries.swap( other.binaries );
+                std::swap( endOfRows, other.endOfRows );
+                error.swap( other.error );
+            }
+
+        private:
+
+            // the new cell, with any space reserved but not used by it released
+            Cell& Append( Cell::Type type )
+            {
+                arena.resize( arenaUsed );
+                cells.push_back( Cell() );
+                cells.back().type = static_cast<uint8_t>( type );
+                cells.back().more = false;
+                return cells.back();
+            }
+        };
+
+        // rows of the batch returned by the last read, which is all of them for ReadRows but one at a time 
+        // for ReadRowValues
+        size_t BatchSize() const
+        {
+            return batchEnd - batchFirst;
+        }
+
+        bool BatchRowsLeft() const
+        {
+            return batchEnd < batch.Rows();
+        }
+
+        // return up to count of the rows of the batch after those already returned
+        void ReturnBatchRows( size_t count )
         {
-            this->column = column;
+            batchFirst = batchEnd;
+            batchEnd = ( batch.Rows() - batchEnd > count ) ? batchEnd + count : batch.Rows();
         }
 
-        shared_ptr<Column> GetColumn()
+        // a column of the last row returned has more data, which is only possible in the batch's last row
+        bool BatchMore() const
         {
-            return column;
+            return batchEnd == batch.Rows() && batch.More();
         }
 
+        // index of the column with more data in the last row of the batch when BatchMore is true
+        int BatchMoreColumn() const
+        {
+            return batch.RowColumns( batch.Rows() - 1 ) - 1;
+        }
+
+        // the column last read by ReadColumn
+        Handle<Value> CurrentToValue()
+        {
+            return current.CellToValue( current.cells.back() );
+        }
+
+        bool CurrentMore() const
+        {
+            return current.More();
+        }
+
+        bool BatchEndOfRows() const
+        {
+            return batchEnd == batch.Rows() && batch.endOfRows;
+        }
+
+        Handle<Value> RowToValue(size_t row);
+
+        Handle<Value> BatchToValue();
+
+        // the batch as an array of objects with a property for each column, named by MakePropertyNames
+        Handle<Value> BatchToObjects();
+
+        // name the properties of row objects from the metadata.  Names that are empty or already used
+        // by an earlier column become Column<n>, or Column<n>_<m> if that is taken too.
+        void MakePropertyNames();
+
+        // the columns read by ReadColumnar, one typed array per column
+        Handle<Value> ColumnarToValue();
+
         SQLLEN RowCount() const
         {
             return rowcount;
@@ -84,10 +411,20 @@ namespace mssql
     private:
 
         vector<ColumnDefinition> metadata;
+        vector<wstring> propertyNames;
+        Persistent<ObjectTemplate> shape;   // of the row objects returned by BatchToObjects, made by its first call
         SQLLEN rowcount;
         bool endOfRows;
-        shared_ptr<Column> column;
+        RowBatch current;               // the column returned by the last ReadColumn
+        RowBatch batch;                 // rows returned by the last read
+        size_t batchFirst;              // the rows of batch returned by the last read
+        size_t batchEnd;
+        deque<RowBatch> prefetched;     // rows read ahead, in order, for the following reads
+        vector<BoundColumn> bound;
+        vector<ColumnarColumn> columnar;    // rows returned by the last ReadColumnar, by column
+        SQLULEN rowsFetched;        // rows in the block last fetched
+        SQLULEN blockRow;           // current row within that block
 
-        friend class OdbcConnection;    // allow access to the endOfRows flag to just the ResultSet creating class
+        friend class OdbcConnection;    // allow access to the endOfRows flag and batches to just the ResultSet creating class
     };
 }
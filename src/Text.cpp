@@ -0,0 +1,191 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: Text.cpp
+// Contents: Scanning and narrowing text converted to Javascript strings
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Text.h"
+
+#if defined( _M_X64 ) || defined( _M_IX86 )
+#define TEXT_SSE2
+#include <intrin.h>
+#include <emmintrin.h>
+#endif
+
+namespace mssql {
+
+namespace {
+
+#ifdef TEXT_SSE2
+
+// x64 processors always have SSE2, 32 bit ones are asked once
+bool HasSse2()
+{
+#ifdef _M_X64
+    return true;
+#else
+    int info[4];
+    __cpuid( info, 1 );
+    return ( info[3] & ( 1 << 26 )) != 0;
+#endif
+}
+
+const bool sse2 = HasSse2();
+
+#endif
+
+}
+
+bool IsAscii( const uint16_t* text, size_t length )
+{
+    size_t i = 0;
+
+#ifdef TEXT_SSE2
+    if( sse2 ) {
+
+        const __m128i high = _mm_set1_epi16( static_cast<short>( 0xff80 ));
+        __m128i seen = _mm_setzero_si128();
+
+        for( ; i + 8 <= length; i += 8 ) {
+            seen = _mm_or_si128( seen, _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + i )));
+        }
+        if( _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( seen, high ), _mm_setzero_si128() )) != 0xffff ) {
+            return false;
+        }
+    }
+#endif
+
+    uint16_t seen = 0;
+    for( ; i < length; ++i ) {
+        seen |= text[i];
+    }
+
+    return seen < 0x80;
+}
+
+bool IsAscii( const char* text, size_t length )
+{
+    size_t i = 0;
+
+#ifdef TEXT_SSE2
+    if( sse2 ) {
+
+        __m128i seen = _mm_setzero_si128();
+
+        for( ; i + 16 <= length; i += 16 ) {
+            seen = _mm_or_si128( seen, _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + i )));
+        }
+        if( _mm_movemask_epi8( seen ) != 0 ) {
+            return false;
+        }
+    }
+#endif
+
+    unsigned char seen = 0;
+    for( ; i < length; ++i ) {
+        seen |= static_cast<unsigned char>( text[i] );
+    }
+
+    return seen < 0x80;
+}
+
+void NarrowAscii( const uint16_t* text, size_t length, char* narrowed )
+{
+    size_t i = 0;
+
+#ifdef TEXT_SSE2
+    if( sse2 ) {
+
+        for( ; i + 16 <= length; i += 16 ) {
+            __m128i first = _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + i ));
+            __m128i second = _mm_loadu_si128( reinterpret_cast<const __m128i*>( text + i + 8 ));
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( narrowed + i ), _mm_packus_epi16( first, second ));
+        }
+    }
+#endif
+
+    for( ; i < length; ++i ) {
+        narrowed[i] = static_cast<char>( text[i] );
+    }
+}
+
+void WidenAnsi( const char* text, size_t length, vector<uint16_t>& widened )
+{
+    widened.resize( length );       // a code page never has fewer bytes than UTF-16 code units
+    if( length == 0 ) {
+        return;
+    }
+
+    int count = MultiByteToWideChar( CP_ACP, 0, text, static_cast<int>( length ), 
+                                     reinterpret_cast<wchar_t*>( widened.data() ), static_cast<int>( length ));
+    widened.resize( count );
+}
+
+size_t FormatNumeric( SQL_NUMERIC_STRUCT const& numeric, char* text )
+{
+    // the 128 bit little endian mantissa as 32 bit limbs, most significant first
+    uint32_t limbs[4];
+    for( int i = 0; i < 4; ++i ) {
+        const SQLCHAR* bytes = numeric.val + i * 4;
+        limbs[3 - i] = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>( bytes[3] ) << 24;
+    }
+
+    bool zero = ( limbs[0] | limbs[1] | limbs[2] | limbs[3] ) == 0;
+
+    // the digits, least significant first, 9 at a time from the remainder of dividing by 10^9
+    char digits[ NUMERIC_TEXT_MAX_LENGTH ];
+    size_t count = 0;
+    bool done;
+    do {
+        uint64_t remainder = 0;
+        done = true;
+        for( int i = 0; i < 4; ++i ) {
+            uint64_t current = remainder << 32 | limbs[i];
+            limbs[i] = static_cast<uint32_t>( current / 1000000000 );
+            remainder = current % 1000000000;
+            done = done && limbs[i] == 0;
+        }
+        for( int d = 0; d < 9; ++d ) {
+            digits[count++] = static_cast<char>( '0' + remainder % 10 );
+            remainder /= 10;
+        }
+    } while( !done );
+
+    // one digit before the point, and no leading zeros before that
+    size_t scale = numeric.scale > 0 ? static_cast<size_t>( numeric.scale ) : 0;
+    while( count < scale + 1 ) {
+        digits[count++] = '0';
+    }
+    while( count > scale + 1 && digits[count - 1] == '0' ) {
+        --count;
+    }
+
+    char* out = text;
+    if( numeric.sign == 0 && !zero ) {
+        *out++ = '-';
+    }
+    for( size_t i = count; i-- > 0; ) {
+        *out++ = digits[i];
+        if( i == scale && scale > 0 ) {
+            *out++ = '.';
+        }
+    }
+
+    return out - text;
+}
+
+}   // namespace mssql
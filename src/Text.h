@@ -0,0 +1,45 @@
+//---------------------------------------------------------------------------------------------------------------------------------
+// File: Text.h
+// Contents: Scanning and narrowing text converted to Javascript strings
+// 
+// Copyright Microsoft Corporation and contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// You may obtain a copy of the License at:
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+namespace mssql
+{
+    using namespace std;
+
+    // true when every UTF-16 code unit is ASCII, so the text can be created as a one byte string.  
+    // Scanned 8 code units at a time with SSE2 when the processor has it.
+    bool IsAscii( const uint16_t* text, size_t length );
+
+    // true when every byte is ASCII, so text in any code page is already valid UTF-8
+    bool IsAscii( const char* text, size_t length );
+
+    // copy ASCII UTF-16 text to one byte per character
+    void NarrowAscii( const uint16_t* text, size_t length, char* narrowed );
+
+    // convert text in the client code page, as returned for SQL_C_CHAR, to UTF-16
+    void WidenAnsi( const char* text, size_t length, vector<uint16_t>& widened );
+
+    // longest text of a SQL_NUMERIC_STRUCT: a sign, 39 digits and the decimal point
+    const size_t NUMERIC_TEXT_MAX_LENGTH = 48;
+
+    // format the exact decimal value of numeric, with as many digits after the point as its scale, and 
+    // return the number of characters written (not null terminated)
+    size_t FormatNumeric( SQL_NUMERIC_STRUCT const& numeric, char* text );
+}
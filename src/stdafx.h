@@ -30,6 +30,9 @@
 
 #include <vector>
 #include <queue>
+#include <deque>
+#include <map>
+#include <set>
 #include <string>
 #include <functional>
 #include <algorithm>
@@ -501,4 +501,131 @@ suite( 'date tests', function() {
         ]);   
     });
   });
+
+    // every day SQL Server can hold, from 0001-01-01 through 9999-12-31
+    var msPerDay = 86400000;
+    var firstDay = -62135596800000;     // 0001-01-01 UTC
+    var dayCount = 3652059;
+
+    test( 'every date in the SQL Server range converts to the right milliseconds', function( test_done ) {
+
+        var tsql = "SELECT DATEADD(day, n, CONVERT(date, '00010101')) FROM " +
+                   "(SELECT TOP " + dayCount + " CONVERT(int, ROW_NUMBER() OVER (ORDER BY (SELECT NULL)) - 1) AS n " +
+                   "FROM sys.all_objects a CROSS JOIN sys.all_objects b CROSS JOIN sys.all_objects c) days ORDER BY n";
+        var day = 0;
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            // no callback, so the rows aren't kept
+            var stmt = conn.queryRaw( { query_str: tsql, prefetch: 4 } );
+
+            stmt.on( 'error', function( e ) { assert.ifError( e ); });
+            stmt.on( 'column', function( c, d ) {
+
+                if( d.valueOf() != firstDay + day * msPerDay ) {
+                    assert.fail( d.valueOf(), firstDay + day * msPerDay, "day " + day + " returned as the wrong date", "==" );
+                }
+                ++day;
+            });
+            stmt.on( 'done', function() {
+
+                assert.equal( day, dayCount );
+                conn.close( test_done );
+            });
+        });
+    });
+
+    test( 'dates across the SQL Server range convert to the right date parameters', function( test_done ) {
+
+        // every 97th day, which lands on every day of the month and year over the range, and the days 
+        // around the leap days of years divisible by 100 and 400
+        var days = [];
+        for( var d = 0; d < dayCount; d += 97 ) {
+            days.push( d );
+        }
+        [ "1600-02-28", "1600-02-29", "1600-03-01", "1700-02-28", "1700-03-01", "1900-02-28", "1900-03-01", 
+          "1969-12-31", "1970-01-01", "2000-02-29", "2000-03-01", "9999-12-31" ].forEach( function( date ) {
+            days.push(( new Date( date + "T00:00:00Z" ).valueOf() - firstDay ) / msPerDay );
+        });
+
+        var batches = [];
+        for( var b = 0; b < days.length; b += 2000 ) {
+            batches.push( days.slice( b, b + 2000 ));
+        }
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            async.forEachSeries( batches, function( batch, async_done ) {
+
+                var values = batch.map( function() { return "(?)"; } ).join( "," );
+                var params = batch.map( function( day ) { return new Date( firstDay + day * msPerDay ); } );
+
+                conn.queryRaw( "SELECT DATEDIFF(day, '00010101', CONVERT(date, d)) FROM (VALUES " + values + ") AS v(d)", params, 
+                               function( e, r ) {
+
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows.map( function( row ) { return row[0]; } ), batch );
+                    async_done();
+                });
+            },
+            function() {
+
+                conn.close( test_done );
+            });
+        });
+    });
+
+    test( 'the dates option returns plain dates or milliseconds', function( test_done ) {
+
+        var tsql = "SELECT CONVERT(datetime2(7), '2012-06-15 10:20:30.1234567'), CONVERT(date, '0001-01-01'), CONVERT(datetime2, NULL)";
+        var ms = Date.UTC( 2012, 5, 15, 10, 20, 30, 123 );
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            async.series([
+                function( async_done ) {
+
+                    conn.queryRaw( tsql, function( e, r ) {
+
+                        assert.ifError( e );
+                        assert.equal( r.rows[0][0].valueOf(), ms );
+                        assert( r.rows[0][0].hasOwnProperty( 'nanosecondsDelta' ));
+                        async_done();
+                    });
+                },
+                function( async_done ) {
+
+                    conn.queryRaw( { query_str: tsql, dates: 'plain' }, function( e, r ) {
+
+                        assert.ifError( e );
+                        assert( r.rows[0][0] instanceof Date );
+                        assert.equal( r.rows[0][0].valueOf(), ms );
+                        assert( !r.rows[0][0].hasOwnProperty( 'nanosecondsDelta' ));
+                        assert.equal( r.rows[0][1].valueOf(), firstDay );
+                        assert.strictEqual( r.rows[0][2], null );
+                        async_done();
+                    });
+                },
+                function( async_done ) {
+
+                    conn.queryRaw( { query_str: tsql, dates: 'number' }, function( e, r ) {
+
+                        assert.ifError( e );
+                        assert.deepEqual( r.rows, [ [ ms, firstDay, null ] ] );
+                        async_done();
+                    });
+                }
+            ],
+            function() {
+
+                conn.close( test_done );
+            });
+        });
+    });
 });
\ No newline at end of file
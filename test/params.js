@@ -753,4 +753,334 @@ suite( 'params', function() {
             test_done );
     });
   });
+
+  test( 'execute a batch of parameter rows in one call', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var rows = [];
+        for( var i = 0; i < 1000; ++i ) {
+            rows.push([ i, 'row ' + i, i % 2 == 0, i % 10 == 0 ? null : i / 4, new Buffer([ i & 0xff ]) ]);
+        }
+
+        testBoilerPlate( 'batch_param_test', { 'int_col': 'int', 'str_col': 'nvarchar(20)', 'bit_col': 'bit', 
+                                               'float_col': 'float', 'bin_col': 'varbinary(1)' },
+
+            function( done ) {
+                conn.executeBatch( "INSERT INTO batch_param_test (int_col, str_col, bit_col, float_col, bin_col) VALUES (?, ?, ?, ?, ?)", 
+                                   rows, function( e, r ) {
+                    assert.ifError( e );
+                    assert.equal( r.rowcount, rows.length );
+                    assert.equal( r.status.length, rows.length );
+                    r.status.forEach( function( s ) { assert.equal( s, 'success' ); });
+                    done();
+                });
+            },
+            function( done ) {
+                conn.queryRaw( "SELECT int_col, str_col, bit_col, float_col, bin_col FROM batch_param_test ORDER BY id", function( e, r ) {
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows, rows );
+                    done();
+                });
+            },
+            test_done );
+    });
+  });
+
+  test( 'batch with one long string sends its column a value at a time', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        // 2000 rows at the stride of a 5000 character value would take 20MB, past the limit for laying out a column
+        var rows = [];
+        for( var i = 0; i < 2000; ++i ) {
+            rows.push([ i, i == 1000 ? new Array( 5001 ).join( 'x' ) : ( i % 7 == 0 ? null : 'row ' + i ) ]);
+        }
+
+        testBoilerPlate( 'batch_long_test', { 'int_col': 'int', 'str_col': 'nvarchar(max)' },
+
+            function( done ) {
+                conn.executeBatch( "INSERT INTO batch_long_test (int_col, str_col) VALUES (?, ?)", rows, function( e, r ) {
+                    assert.ifError( e );
+                    assert.equal( r.rowcount, rows.length );
+                    done();
+                });
+            },
+            function( done ) {
+                conn.queryRaw( "SELECT int_col, str_col FROM batch_long_test ORDER BY id", function( e, r ) {
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows, rows );
+                    done();
+                });
+            },
+            test_done );
+    });
+  });
+
+  test( 'verify batch rows with differing parameter types return an error', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        conn.executeBatch( "SELECT ?", [ [ 1 ], [ 'one' ] ], function( e, r ) {
+            assert( e == "Error: IMNOD: [msnodesql] Row 2, parameter 1: Type differs from earlier rows" );
+            test_done();
+        });
+    });
+  });
+
+  test( 'bulk load rows in batches', function( test_done ) {
+
+    sql.open( conn_str, { bulkLoad: true }, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var count = 25000;
+
+        testBoilerPlate( 'bulk_load_test', { 'int_col': 'int', 'str_col': 'nvarchar(20)', 'date_col': 'datetimeoffset' },
+
+            function( done ) {
+                var load = conn.bulkLoad( 'bulk_load_test', [ 'str_col', 'int_col', 'date_col' ], { batchSize: 10000 } );
+                load.on( 'error', function( e ) { assert.ifError( e ); });
+                load.on( 'done', function( rowcount ) {
+                    assert.equal( rowcount, count );
+                    done();
+                });
+                for( var i = 0; i < count; ++i ) {
+                    if( i % 2 == 0 ) {
+                        load.write([ 'row ' + i, i, i % 3 == 0 ? null : new Date( Date.UTC( 2013, 0, 1 ) + i * 1000 ) ]);
+                    }
+                    else {
+                        load.write({ int_col: i, str_col: 'row ' + i });
+                    }
+                }
+                load.end();
+            },
+            function( done ) {
+                conn.queryRaw( "SELECT COUNT(*), SUM(CAST(int_col AS bigint)), COUNT(date_col), MAX(str_col) FROM bulk_load_test", function( e, r ) {
+                    assert.ifError( e );
+                    var dated = 0;
+                    for( var i = 0; i < count; i += 2 ) {
+                        if( i % 3 != 0 ) { ++dated; }
+                    }
+                    assert.deepEqual( r.rows, [[ count, count * ( count - 1 ) / 2, dated, 'row 9999' ]] );
+                    done();
+                });
+            },
+            test_done );
+    });
+  });
+
+  test( 'verify bulk load needs a connection opened with the bulkLoad option', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        assert.throws( function() {
+            conn.bulkLoad( 'bulk_load_test', [ 'int_col' ] );
+        }, /Connection must be opened with the bulkLoad option/ );
+
+        conn.close();
+        test_done();
+    });
+  });
+
+  test( 'verify a bulk load table name is quoted rather than run as SQL', function( test_done ) {
+
+    sql.open( conn_str, { bulkLoad: true }, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var load = conn.bulkLoad( "bulk_load_test; SELECT 1", [ 'int_col' ] );
+        load.on( 'error', function( e ) {
+            assert( e.message.indexOf( "Invalid object name 'bulk_load_test; SELECT 1'" ) >= 0 );
+            test_done();
+        });
+        load.end([ 1 ]);
+    });
+  });
+
+  test( 'verify bulk load into a missing column returns an error', function( test_done ) {
+
+    sql.open( conn_str, { bulkLoad: true }, function( err, conn ) {
+
+        assert.ifError( err );
+
+        testBoilerPlate( 'bulk_load_missing', { 'int_col': 'int' },
+
+            function( done ) {
+                var load = conn.bulkLoad( 'bulk_load_missing', [ 'no_such_col' ] );
+                load.on( 'error', function( e ) {
+                    assert.equal( e.message, "[msnodesql] Column no_such_col not found in table bulk_load_missing." );
+                    // the connection is usable once the load fails
+                    conn.queryRaw( "SELECT COUNT(*) FROM bulk_load_missing", function( e, r ) {
+                        assert.ifError( e );
+                        assert.deepEqual( r.rows, [[ 0 ]] );
+                        done();
+                    });
+                });
+                load.end([ 1 ]);
+            },
+            function( done ) {
+                done();
+            },
+            test_done );
+    });
+  });
+
+  test( 'pass rows to a stored procedure as a table-valued parameter', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var rows = [];
+        for( var i = 0; i < 10000; ++i ) {
+            rows.push([ i, i % 7 == 0 ? null : 'row ' + i ]);
+        }
+
+        async.series( [
+            function( done ) {
+                conn.queryRaw( "IF OBJECT_ID('tvp_param_proc', 'P') IS NOT NULL DROP PROCEDURE tvp_param_proc", done );
+            },
+            function( done ) {
+                conn.queryRaw( "IF TYPE_ID('dbo.tvp_param_type') IS NOT NULL DROP TYPE dbo.tvp_param_type", done );
+            },
+            function( done ) {
+                conn.queryRaw( "CREATE TYPE dbo.tvp_param_type AS TABLE (id int, name nvarchar(20))", done );
+            },
+            function( done ) {
+                conn.queryRaw( "CREATE PROCEDURE tvp_param_proc @rows dbo.tvp_param_type READONLY, @offset int AS " +
+                               "SELECT COUNT(*), SUM(CAST(id AS bigint)) + @offset, COUNT(name), MAX(name) FROM @rows", done );
+            },
+            function( done ) {
+                conn.queryRaw( "EXEC tvp_param_proc ?, ?", [ sql.tvp( 'dbo.tvp_param_type', rows ), 1 ], function( e, r ) {
+                    assert.ifError( e );
+                    var named = rows.filter( function( row ) { return row[1] != null; }).length;
+                    assert.deepEqual( r.rows, [[ 10000, 10000 * 9999 / 2 + 1, named, 'row 9999' ]] );
+                    done();
+                });
+            },
+            function( done ) {
+                var columns = { id: [ 1, 2, 3 ], name: [ 'a', null, 'c' ] };
+                conn.queryRaw( "EXEC tvp_param_proc ?, ?", [ sql.tvp( 'tvp_param_type', columns ), 0 ], function( e, r ) {
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows, [[ 3, 6, 2, 'c' ]] );
+                    done();
+                });
+            },
+            function( done ) {
+                conn.queryRaw( "EXEC tvp_param_proc ?, ?", [ sql.tvp( 'tvp_param_type', [] ), 0 ], function( e, r ) {
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows, [[ 0, null, 0, null ]] );
+                    done();
+                });
+            }
+        ],
+        function( err ) {
+            assert.ifError( err );
+            test_done();
+        });
+    });
+  });
+
+  test( 'select many parameters of mixed types', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var params = [];
+        var placeholders = [];
+        for( var i = 0; i < 60; ++i ) {
+            switch( i % 6 ) {
+                case 0: params.push( 'string ' + i ); break;
+                case 1: params.push( i % 4 == 1 ); break;
+                case 2: params.push( i * 1000 ); break;
+                case 3: params.push( i + 0.5 ); break;
+                case 4: params.push( null ); break;
+                case 5: params.push( 4294967295 - i ); break;
+            }
+            placeholders.push( '?' );
+        }
+
+        conn.queryRaw( "SELECT " + placeholders.join( ', ' ), params, function( e, r ) {
+            assert.ifError( e );
+            assert.deepEqual( r.rows, [ params ] );
+            test_done();
+        });
+    });
+  });
+
+  test( 'string parameters of many lengths share rounded declared sizes', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var lengths = [];
+        for( var l = 1; l <= 100; ++l ) {
+            lengths.push( l );
+        }
+
+        function run( query, done ) {
+            async.forEachSeries( lengths, function( l, next ) {
+                var s = new Array( l + 1 ).join( 'x' );
+                conn.queryRaw( query, [ s ], function( e, r ) {
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows, [[ s ]] );
+                    next();
+                });
+            }, done );
+        }
+
+        var exact = { query_str: "SELECT ? AS exact", paramSizes: 'exact' };
+        var declared = { query_str: "SELECT ? AS declared", paramSizes: [ 100 ] };
+
+        async.series( [
+            function( done ) { run( "SELECT ? AS rounded", done ); },
+            function( done ) { run( exact, done ); },
+            function( done ) { run( declared, done ); }
+        ],
+        function( err ) {
+            assert.ifError( err );
+            assert.equal( conn.paramSignatures( "SELECT ? AS rounded" ), 2 );
+            assert.equal( conn.paramSignatures( exact ), 100 );
+            assert.equal( conn.paramSignatures( declared ), 1 );
+            assert.equal( conn.paramSignatures(), 103 );
+            test_done();
+        });
+    });
+  });
+
+  test( 'verify a value longer than its size in paramSizes returns an error', function( test_done ) {
+
+    sql.open( conn_str, function( err, conn ) {
+
+        assert.ifError( err );
+
+        var query = { query_str: "SELECT ?, ? AS too_long", paramSizes: [ null, 10 ] };
+
+        conn.queryRaw( query, [ 'fits', new Array( 12 ).join( 'x' ) ], function( e, r ) {
+            assert( e == "Error: IMNOD: [msnodesql] Parameter 2: Value is longer than its size in paramSizes" );
+
+            conn.queryRaw( query, [ 'fits', new Buffer( 11 ) ], function( e, r ) {
+                assert( e == "Error: IMNOD: [msnodesql] Parameter 2: Value is longer than its size in paramSizes" );
+
+                // a value of the size given binds as usual
+                conn.queryRaw( query, [ 'fits', new Array( 11 ).join( 'x' ) ], function( e, r ) {
+                    assert.ifError( e );
+                    assert.deepEqual( r.rows, [[ 'fits', new Array( 11 ).join( 'x' ) ]] );
+                    test_done();
+                });
+            });
+        });
+    });
+  });
 });
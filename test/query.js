@@ -23,6 +23,8 @@ var buffer=require('buffer');
 
 var assert = require( 'assert' );
 var async = require( 'async' );
+var fs = require( 'fs' );
+var path = require( 'path' );
 
 var config = require( './test-config' );
 
@@ -663,4 +665,567 @@ suite('query', function () {
             }
         ]);
     });
+
+    test( 'whole row read continues past a LOB column in the middle of a row', function( done ) {
+
+        var r = sql.queryRaw( conn_str, "SELECT 1 AS X, REPLICATE(CONVERT(nvarchar(max), N'A'), 10000) AS L, 'ABC' AS Y" );
+
+        var received = [];
+        var lob = '';
+
+        r.on('row', function( idx ) { received.push( { row: idx } ); } );
+        r.on('column', function( idx, data, more ) {
+            if( idx == 1 ) {
+                lob += data;
+                if( more ) {
+                    return;
+                }
+                data = lob;
+            }
+            received.push( { column: idx, data: data } );
+        });
+        r.on('done', function() {
+
+            var expected = [ { row: 0 },
+                             { column: 0, data: 1 },
+                             { column: 1, data: new Array( 10001 ).join( 'A' ) },
+                             { column: 2, data: 'ABC' } ];
+            assert.deepEqual( received, expected );
+            done();
+        });
+        r.on('error', function( e ) { assert.ifError( e ); } );
+    });
+
+    test( 'query returns row objects with repeated and empty column names and a LOB in the middle', function( done ) {
+
+        sql.query( conn_str, "SELECT 1 AS Column1, REPLICATE(CONVERT(nvarchar(max), N'A'), 10000) AS Column1, 'ABC', 3 AS Z " +
+                             "UNION ALL SELECT 4, N'B', 'DEF', 6", function( err, results ) {
+
+            assert.ifError( err );
+
+            var expected = [ { Column1: 1, Column1_0: new Array( 10001 ).join( 'A' ), Column2: 'ABC', Z: 3 },
+                             { Column1: 4, Column1_0: 'B', Column2: 'DEF', Z: 6 } ];
+            assert.deepEqual( results, expected );
+            assert.deepEqual( Object.keys( results[0] ), [ 'Column1', 'Column1_0', 'Column2', 'Z' ] );
+            done();
+        });
+    });
+
+    test( 'rows spanning several read batches are returned in order', function( done ) {
+
+        var expected_rows = 1000;
+        var current_row = 0;
+
+        var stmt = sql.queryRaw( conn_str, "SELECT TOP " + expected_rows + " ROW_NUMBER() OVER (ORDER BY a.object_id) - 1 AS n " +
+                                           "FROM sys.all_objects a CROSS JOIN sys.all_objects b ORDER BY n",
+            function( err, results ) {
+
+                assert.ifError( err );
+                assert.equal( results.rows.length, expected_rows );
+                for( var i = 0; i < results.rows.length; ++i ) {
+                    assert.deepEqual( results.rows[i], [ i ] );
+                }
+                assert.equal( current_row, expected_rows );
+                done();
+            });
+
+        stmt.on( 'row', function( idx ) { assert.equal( idx, current_row ); ++current_row; } );
+    });
+
+    test( 'fixed width columns fetched in blocks return correct values and nulls', function( done ) {
+
+        var expected_rows = 5000;
+
+        sql.queryRaw( conn_str, "SELECT n, CASE WHEN n % 7 = 0 THEN NULL ELSE CONVERT(float, n) / 4 END AS f, CONVERT(bit, n % 2) AS b, " +
+                                "CONVERT(nvarchar(20), N'row ' + CONVERT(nvarchar(10), n)) AS s, " +
+                                "DATEADD(day, n, CONVERT(datetime2, '2000-01-01')) AS d " +
+                                "FROM (SELECT TOP " + expected_rows + " CONVERT(int, ROW_NUMBER() OVER (ORDER BY a.object_id) - 1) AS n " +
+                                "FROM sys.all_objects a CROSS JOIN sys.all_objects b) AS numbers ORDER BY n",
+            function( err, results ) {
+
+                assert.ifError( err );
+                assert.equal( results.rows.length, expected_rows );
+
+                for( var n = 0; n < results.rows.length; ++n ) {
+
+                    var row = results.rows[n];
+                    assert.equal( row[0], n );
+                    assert.strictEqual( row[1], n % 7 == 0 ? null : n / 4 );
+                    assert.strictEqual( row[2], n % 2 == 1 );
+                    assert.equal( row[3], 'row ' + n );
+                    assert.equal( row[4].getTime(), Date.UTC( 2000, 0, 1 + n ));
+                }
+
+                done();
+            });
+    });
+
+    test( 'query options object with different read ahead depths returns the same rows', function( done ) {
+
+        var tsql = "SELECT TOP 2000 CONVERT(int, ROW_NUMBER() OVER (ORDER BY a.object_id)) AS n, a.name " +
+                   "FROM sys.all_objects a CROSS JOIN sys.all_objects b ORDER BY n";
+        var results = [];
+
+        async.forEachSeries( [ 0, 1, 4 ], function( prefetch, async_done ) {
+
+            sql.queryRaw( conn_str, { query_str: tsql, prefetch: prefetch }, function( err, r ) {
+
+                assert.ifError( err );
+                assert.equal( r.rows.length, 2000 );
+                results.push( r );
+                async_done();
+            });
+        },
+        function() {
+
+            assert.deepEqual( results[0], results[1] );
+            assert.deepEqual( results[0], results[2] );
+            done();
+        });
+    });
+
+    test( 'query stream returns row objects with flow control', function( done ) {
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            var tsql = "SELECT TOP 1000 CONVERT(int, ROW_NUMBER() OVER (ORDER BY a.object_id)) AS n, 'ABC' AS s " +
+                       "FROM sys.all_objects a CROSS JOIN sys.all_objects b ORDER BY n";
+            var received = 0;
+            var meta_events = 0;
+
+            var rows = conn.queryStream( tsql, [], { highWaterMark: 10 } );
+
+            rows.on( 'meta', function( meta ) { 
+                ++meta_events;
+                assert.equal( meta.length, 2 );
+            });
+            rows.on( 'readable', function() {
+
+                var row;
+                while(( row = rows.read()) !== null ) {
+                    ++received;
+                    assert.deepEqual( row, { n: received, s: 'ABC' } );
+                }
+            });
+            rows.on( 'end', function() {
+
+                assert.equal( received, 1000 );
+                assert.equal( meta_events, 1 );
+                conn.close( done );
+            });
+            rows.on( 'error', function( e ) { assert.ifError( e ); } );
+        });
+    });
+
+    test( 'raw query stream across multiple result sets', function( done ) {
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            var received = [];
+
+            var rows = conn.queryStream( "SELECT 1 AS X, 'ABC'; SELECT 2 AS Y, 'DEF'", [], { raw: true } );
+
+            rows.on( 'data', function( row ) { received.push( row ); } );
+            rows.on( 'end', function() {
+
+                assert.deepEqual( received, [ [ 1, 'ABC' ], [ 2, 'DEF' ] ] );
+                conn.close( done );
+            });
+            rows.on( 'error', function( e ) { assert.ifError( e ); } );
+        });
+    });
+
+    test( 'columnar query returns typed arrays, offsets and null bitmaps', function( done ) {
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            var tsql = "SELECT TOP 300 CONVERT(int, ROW_NUMBER() OVER (ORDER BY a.object_id)) AS n, " +
+                       "CASE WHEN ROW_NUMBER() OVER (ORDER BY a.object_id) % 3 = 0 THEN NULL ELSE N'v' + CONVERT(nvarchar(10), ROW_NUMBER() OVER (ORDER BY a.object_id)) END AS s " +
+                       "FROM sys.all_objects a CROSS JOIN sys.all_objects b ORDER BY n; SELECT 1";
+
+            conn.queryColumnar( tsql, function( err, results, more ) {
+
+                assert.ifError( err );
+
+                if( !more ) {
+                    assert.equal( results.rows, 1 );
+                    assert.equal( results.columns[0].values[0], 1 );
+                    conn.close( done );
+                    return;
+                }
+
+                assert.equal( results.rows, 300 );
+                assert.equal( results.meta.length, 2 );
+
+                var n = results.columns[0];
+                var s = results.columns[1];
+                assert.equal( n.type, 'int32' );
+                assert.equal( s.type, 'text' );
+
+                for( var i = 0; i < results.rows; ++i ) {
+
+                    assert.equal( n.values[i], i + 1 );
+                    assert.equal( n.nulls[i >> 3] & ( 1 << ( i & 7 )), 0 );
+
+                    var isNull = ( s.nulls[i >> 3] & ( 1 << ( i & 7 ))) != 0;
+                    assert.equal( isNull, ( i + 1 ) % 3 == 0 );
+                    if( !isNull ) {
+                        assert.equal( s.data.toString( 'ucs2', s.offsets[i], s.offsets[i + 1] ), 'v' + ( i + 1 ));
+                    }
+                }
+            });
+        });
+    });
+
+    test( 'repeated query on a connection returns the metadata of changed columns', function( done ) {
+
+        sql.open( conn_str, function( e, c ) {
+
+            assert.ifError( e );
+
+            var tsql = "SELECT * FROM metadata_cache_test; SELECT 1 AS one";
+
+            async.series([
+                function( async_done ) {
+
+                    c.queryRaw( "DROP TABLE metadata_cache_test", function( e ) { async_done(); } );
+                },
+                function( async_done ) {
+
+                    c.queryRaw( "CREATE TABLE metadata_cache_test (id int, name varchar(20)); INSERT INTO metadata_cache_test VALUES (1, 'A')", 
+                                function( e ) {
+
+                                    assert.ifError( e );
+                                    async_done();
+                                });
+                },
+                function( async_done ) {
+
+                    var results = [];
+
+                    c.queryRaw( tsql, function( e, r, more ) {
+
+                        assert.ifError( e );
+                        results.push( r );
+                        if( more ) {
+                            return;
+                        }
+
+                        c.queryRaw( tsql, function( e, r, more ) {
+
+                            assert.ifError( e );
+                            assert.deepEqual( r, results.shift() );
+                            if( !more ) {
+                                async_done();
+                            }
+                        });
+                    });
+                },
+                function( async_done ) {
+
+                    c.queryRaw( "ALTER TABLE metadata_cache_test ALTER COLUMN id bigint", function( e ) {
+
+                        assert.ifError( e );
+                        async_done();
+                    });
+                },
+                function( async_done ) {
+
+                    c.queryRaw( tsql, function( e, r, more ) {
+
+                        assert.ifError( e );
+                        if( more ) {
+                            assert.equal( r.meta[0].sqlType, 'bigint' );
+                            assert.deepEqual( r.rows, [ [ 1, 'A' ] ] );
+                        }
+                        else {
+                            assert.equal( r.meta[0].name, 'one' );
+                            async_done();
+                        }
+                    });
+                },
+                function( async_done ) {
+
+                    c.queryRaw( "ALTER TABLE metadata_cache_test ALTER COLUMN name varchar(max); " +
+                                "UPDATE metadata_cache_test SET name = REPLICATE(CONVERT(varchar(max), 'B'), 10000)", function( e ) {
+
+                        assert.ifError( e );
+                        async_done();
+                    });
+                },
+                function( async_done ) {
+
+                    c.queryRaw( tsql, function( e, r, more ) {
+
+                        assert.ifError( e );
+                        if( more ) {
+                            assert.equal( r.meta[1].sqlType, 'varchar' );
+                            assert.equal( r.rows[0][1], new Array( 10001 ).join( 'B' ));
+                        }
+                        else {
+                            async_done();
+                        }
+                    });
+                },
+                function( async_done ) {
+
+                    c.queryRaw( "DROP TABLE metadata_cache_test", function( e ) { async_done(); } );
+                }
+            ],
+            function() {
+
+                c.close( done );
+            });
+        });
+    });
+
+    test( 'binary values of all sizes are returned whole in a single Buffer', function( done ) {
+
+        sql.queryRaw( conn_str, "SELECT CONVERT(varbinary(max), REPLICATE(CONVERT(varchar(max), 'AB'), 50000)), " +
+                                "CONVERT(varbinary(20), 'abc'), CONVERT(varbinary(max), ''), CONVERT(varbinary(10), NULL)", function( err, results ) {
+
+            assert.ifError( err );
+
+            var row = results.rows[0];
+            assert( Buffer.isBuffer( row[0] ));
+            assert.equal( row[0].length, 100000 );
+            assert.equal( row[0].toString( 'ascii' ), new Array( 50001 ).join( 'AB' ));
+            assert.deepEqual( row[1], new Buffer( 'abc', 'ascii' ));
+            assert.equal( row[2].length, 0 );
+            assert.strictEqual( row[3], null );
+            done();
+        });
+    });
+
+    test( 'large object values are read whole by default or in pieces of lobChunkSize', function( done ) {
+
+        var tsql = "SELECT REPLICATE(CONVERT(nvarchar(max), N'xyz'), 20000), CONVERT(varbinary(max), REPLICATE(CONVERT(varchar(max), 'AB'), 5000))";
+        var text = new Array( 20001 ).join( 'xyz' );
+
+        sql.open( conn_str, function( err, conn ) {
+
+            assert.ifError( err );
+
+            async.forEachSeries( [ 0, 1000 ], function( chunkSize, async_done ) {
+
+                var pieces = [ 0, 0 ];
+                var streamed = '';
+
+                var stmt = conn.queryRaw( { query_str: tsql, lobChunkSize: chunkSize }, function( e, r ) {
+
+                    assert.ifError( e );
+                    assert.equal( r.rows[0][0], text );
+                    assert.equal( r.rows[0][1].toString( 'ascii' ), new Array( 5001 ).join( 'AB' ));
+                    assert.equal( streamed, text );
+
+                    if( chunkSize == 0 ) {
+                        assert.deepEqual( pieces, [ 1, 1 ] );
+                    }
+                    else {
+                        assert.deepEqual( pieces, [ 60, 10 ] );
+                    }
+                    async_done();
+                });
+
+                stmt.on( 'column', function( c, d, more ) {
+
+                    ++pieces[c];
+                    assert( chunkSize == 0 ? !more : d.length <= chunkSize );
+                    if( c == 0 ) {
+                        streamed += d;
+                    }
+                });
+            },
+            function() {
+
+                conn.close( done );
+            });
+        });
+    });
+
+    test( 'values of the lobSink column are written to its file and their sizes returned', function( done ) {
+
+        var sinkPath = path.join( __dirname, 'lob_sink_test.bin' );
+        var tsql = "SELECT 1, CONVERT(varbinary(max), REPLICATE(CONVERT(varchar(max), 'AB'), 1000000)) UNION ALL " +
+                   "SELECT 2, NULL UNION ALL SELECT 3, CONVERT(varbinary(max), 'xyz') ORDER BY 1";
+
+        sql.queryRaw( conn_str, { query_str: tsql, lobSink: { column: 1, path: sinkPath }}, function( err, results ) {
+
+            assert.ifError( err );
+            assert.deepEqual( results.rows, [ [ 1, 2000000 ], [ 2, null ], [ 3, 3 ] ] );
+
+            var written = fs.readFileSync( sinkPath );
+            fs.unlinkSync( sinkPath );
+
+            assert.equal( written.length, 2000003 );
+            assert.equal( written.toString( 'ascii', 0, 4 ), 'ABAB' );
+            assert.equal( written.toString( 'ascii', 2000000 ), 'xyz' );
+            done();
+        });
+    });
+
+    test( 'verify a lobSink column that is not a large object returns an error', function( done ) {
+
+        var sinkPath = path.join( __dirname, 'lob_sink_column_test.bin' );
+
+        sql.queryRaw( conn_str, { query_str: "SELECT 1, CONVERT(varbinary(10), 'xyz')", lobSink: { column: 1, path: sinkPath }}, function( err, results ) {
+
+            if( fs.existsSync( sinkPath )) {
+                fs.unlinkSync( sinkPath );
+            }
+
+            assert.equal( err.message, "The lobSink column is not a large object column" );
+            assert.equal( err.sqlstate, 'IMSNK' );
+            done();
+        });
+    });
+
+    test( 'strings are the same whether varchar is read narrow or as UTF-16', function( done ) {
+
+        var queries = [
+            // all bound to arrays and fetched in blocks
+            "SELECT CONVERT(varchar(10), 'abc'), CONVERT(char(5), 'de'), N'héllo', CONVERT(varchar(10), NULL), CONVERT(varchar(10), '')",
+            // read a column at a time
+            "SELECT CONVERT(varchar(300), REPLICATE('xyz', 100)), CONVERT(char(5), 'de'), N'héllo', CONVERT(varchar(300), NULL), CONVERT(varchar(300), '')"
+        ];
+
+        async.forEachSeries( queries, function( tsql, async_done ) {
+
+            sql.queryRaw( conn_str, tsql, function( err, wide ) {
+
+                assert.ifError( err );
+
+                sql.queryRaw( conn_str, { query_str: tsql, narrowVarchar: true }, function( err, narrow ) {
+
+                    assert.ifError( err );
+                    assert.deepEqual( narrow.rows, wide.rows );
+                    assert.equal( narrow.rows[0][1], 'de   ' );
+                    assert.equal( narrow.rows[0][2], 'héllo' );
+                    async_done();
+                });
+            });
+        },
+        done );
+    });
+
+    test( 'long strings returned as external strings keep their text', function( done ) {
+
+        var tsql = "SELECT REPLICATE(CONVERT(nvarchar(max), N'ab€'), 10000), REPLICATE(CONVERT(nvarchar(max), N'cd'), 10000), " +
+                   "REPLICATE(CONVERT(nvarchar(max), N'e'), 8191)";
+
+        async.forEachSeries( [ 0, 20000 ], function( chunkSize, async_done ) {
+
+            sql.queryRaw( conn_str, { query_str: tsql, lobChunkSize: chunkSize }, function( err, results ) {
+
+                assert.ifError( err );
+
+                var row = results.rows[0];
+                assert.equal( row[0], new Array( 10001 ).join( 'ab€' ));
+                assert.equal( row[1], new Array( 10001 ).join( 'cd' ));
+                assert.equal( row[2], new Array( 8192 ).join( 'e' ));
+                assert.equal( row[0].slice( 29997 ), 'ab€' );
+                async_done();
+            });
+        },
+        done );
+    });
+
+    test( 'bigint values are exact as strings with the bigint option', function( done ) {
+
+        var tsql = "SELECT CONVERT(bigint, 9007199254740993), CONVERT(bigint, -9223372036854775808), CONVERT(bigint, NULL), CONVERT(bigint, 42)";
+
+        sql.queryRaw( conn_str, tsql, function( err, results ) {
+
+            assert.ifError( err );
+            assert.deepEqual( results.rows, [ [ 9007199254740992, -9223372036854775808, null, 42 ] ] );
+
+            sql.queryRaw( conn_str, { query_str: tsql, bigint: 'string' }, function( err, results ) {
+
+                assert.ifError( err );
+                assert.deepEqual( results.rows, [ [ '9007199254740993', '-9223372036854775808', null, '42' ] ] );
+
+                sql.open( conn_str, function( err, conn ) {
+
+                    assert.ifError( err );
+
+                    conn.queryColumnar( { query_str: tsql, bigint: 'string' }, function( err, results ) {
+
+                        assert.ifError( err );
+
+                        var values = results.columns[0].values;
+                        assert.equal( results.columns[0].type, 'int64' );
+                        assert.equal( values[0], 1 );
+                        assert.equal( values[1], 0x200000 );
+                        assert.equal( results.columns[1].values[0], 0 );
+                        assert.equal( results.columns[1].values[1], -2147483648 );
+                        assert.equal( results.columns[2].nulls[0], 1 );
+                        conn.close( done );
+                    });
+                });
+            });
+        });
+    });
+
+    test( 'decimal values are exact as strings with the decimal option', function( done ) {
+
+        var queries = [
+            // all bound to arrays and fetched in blocks
+            "SELECT CONVERT(decimal(38,10), '1234567890123456789012345678.0123456789'), CONVERT(numeric(5,2), -1.5), " +
+            "CONVERT(money, 12.34), CONVERT(decimal(10,4), NULL), CONVERT(decimal(18,0), 0)",
+            // read a column at a time
+            "SELECT CONVERT(decimal(38,10), '1234567890123456789012345678.0123456789'), CONVERT(numeric(5,2), -1.5), " +
+            "CONVERT(money, 12.34), CONVERT(decimal(10,4), NULL), CONVERT(decimal(18,0), 0), CONVERT(nvarchar(max), N'x')"
+        ];
+
+        async.forEachSeries( queries, function( tsql, async_done ) {
+
+            sql.queryRaw( conn_str, { query_str: tsql, decimal: 'string' }, function( err, results ) {
+
+                assert.ifError( err );
+                assert.deepEqual( results.rows[0].slice( 0, 5 ), [ '1234567890123456789012345678.0123456789', '-1.50', '12.3400', null, '0' ] );
+                async_done();
+            });
+        },
+        done );
+    });
+
+    test( 'readRowValues returns a row at a time and readRows the rows after it', function( done ) {
+
+        var ext = new ( require( '../lib/sqlserver.native' ).Connection )();
+
+        ext.open( conn_str, function( err ) {
+
+            assert.ifError( err );
+
+            ext.query( "SELECT n FROM (VALUES (1), (2), (3)) AS t(n) ORDER BY n", [], {}, function( err ) {
+
+                assert.ifError( err );
+
+                ext.readRowValues( function( err, row ) {
+
+                    assert.ifError( err );
+                    assert.deepEqual( row, { endOfRows: false, data: [ 1 ], more: false } );
+
+                    ext.readRows( 10, false, function( err, batch ) {
+
+                        assert.ifError( err );
+                        assert.deepEqual( batch.rows, [ [ 2 ], [ 3 ] ] );
+
+                        ext.readRowValues( function( err, row ) {
+
+                            assert.ifError( err );
+                            assert.deepEqual( row, { endOfRows: true } );
+                            ext.close( done );
+                        });
+                    });
+                });
+            });
+        });
+    });
 });